@@ -1,18 +1,57 @@
+// Expose POSIX/GNU APIs (clock_gettime, usleep) under strict -std=c99
+#ifndef _WIN32
+#define _GNU_SOURCE
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <math.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include <unistd.h>  
 #include <fcntl.h> // Added for _setmode
+#include <errno.h>
+
+// Set by the command-line batch/benchmark modes: turns off every animation,
+// sleep and screen clear so the data structure functions run at full speed
+int headlessMode = 0;
+
+// Set while the last rendered frame is still exactly what the top of the
+// screen shows, so the next frame may redraw only the lines that changed
+int frameValid = 0;
 
 #ifdef _WIN32
 #include <windows.h>
 #include <conio.h> // Includes _getch() for single character input
-#define SLEEP(ms) Sleep(ms)
+#define SLEEP(ms)          \
+    do                     \
+    {                      \
+        if (!headlessMode) \
+            Sleep(ms);     \
+    } while (0)
 #else
-#define SLEEP(ms) usleep(ms * 1000)
+#define SLEEP(ms)                \
+    do                           \
+    {                            \
+        if (!headlessMode)       \
+            usleep((ms) * 1000); \
+    } while (0)
 #include <termios.h>
 #include <unistd.h>
+#include <sys/resource.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <sched.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
 
 // Non-Windows getch implementation
 int getch()
@@ -32,10 +71,18 @@ int getch()
 // Clear screen function
 void clear()
 {
+    if (headlessMode)
+    {
+        return;
+    }
+
+    frameValid = 0;
 #ifdef _WIN32
     system("cls");
 #else
-    system("clear");
+    // ANSI home + erase instead of forking the clear(1) command
+    fputs("\033[H\033[2J", stdout);
+    fflush(stdout);
 #endif
 }
 
@@ -60,6 +107,7 @@ void setColor(int color)
 // Windows-specific getch wrapper
 int getch_wrapper()
 {
+    frameValid = 0; // Output before a key prompt may have scrolled the screen
     return _getch();
 }
 #else
@@ -81,10 +129,436 @@ void setColor(const char *color)
 // Unix-specific getch wrapper
 int getch_wrapper()
 {
+    frameValid = 0; // Output before a key prompt may have scrolled the screen
     return getch();
 }
 #endif
 
+// Frame Renderer Functions-------------------------------------------------------------
+// A demo screen is composed into frameBuffer between beginFrame() and
+// frameFlush(), then written with a single write(). While the previous frame
+// is still on screen only the changed lines are rewritten, using ANSI cursor
+// addressing; colors travel inside the buffer as ANSI sequences
+#define FRAME_SCROLL_MARGIN 8 // Rows kept free below a frame for messages
+
+typedef struct
+{
+    char *data;
+    size_t length;
+    size_t capacity;
+} FrameBuffer;
+
+FrameBuffer frameBuffer = {NULL, 0, 0}; // Frame being composed
+FrameBuffer shownFrame = {NULL, 0, 0};  // Frame currently on screen
+FrameBuffer frameOutput = {NULL, 0, 0}; // Bytes sent to the terminal
+int frameActive = 0;                    // framePrintf goes to frameBuffer
+#ifdef _WIN32
+int virtualTerminalEnabled = 0; // Console told to interpret ANSI sequences
+#endif
+
+void frameReserve(FrameBuffer *buffer, size_t extra)
+{
+    if (buffer->length + extra <= buffer->capacity)
+    {
+        return;
+    }
+
+    size_t capacity = buffer->capacity > 0 ? buffer->capacity : 4096;
+    while (capacity < buffer->length + extra)
+    {
+        capacity *= 2;
+    }
+    buffer->data = (char *)realloc(buffer->data, capacity);
+    if (buffer->data == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    buffer->capacity = capacity;
+}
+
+void bufferAppend(FrameBuffer *buffer, const char *text, size_t length)
+{
+    frameReserve(buffer, length);
+    memcpy(buffer->data + buffer->length, text, length);
+    buffer->length += length;
+}
+
+void bufferVprintf(FrameBuffer *buffer, const char *format, va_list args)
+{
+    va_list retry;
+    va_copy(retry, args);
+    frameReserve(buffer, 256);
+    int written = vsnprintf(buffer->data + buffer->length, buffer->capacity - buffer->length, format, args);
+
+    if (written >= 0 && (size_t)written >= buffer->capacity - buffer->length)
+    {
+        frameReserve(buffer, written + 1);
+        vsnprintf(buffer->data + buffer->length, buffer->capacity - buffer->length, format, retry);
+    }
+    va_end(retry);
+    if (written > 0)
+    {
+        buffer->length += written;
+    }
+}
+
+void bufferPrintf(FrameBuffer *buffer, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    bufferVprintf(buffer, format, args);
+    va_end(args);
+}
+
+// Starts composing a screen; the caller's frameFlush() puts it on screen
+void beginFrame()
+{
+    frameBuffer.length = 0;
+    frameActive = 1;
+}
+
+// printf that lands in the frame being composed, or on stdout otherwise
+void framePrintf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    if (frameActive)
+    {
+        bufferVprintf(&frameBuffer, format, args);
+    }
+    else
+    {
+        vprintf(format, args);
+    }
+    va_end(args);
+}
+
+#ifdef _WIN32
+// Console attribute to the matching ANSI sequence
+const char *ansiColor(int color)
+{
+    switch (color)
+    {
+    case RED:
+        return "\033[91m";
+    case GREEN:
+        return "\033[92m";
+    case YELLOW:
+        return "\033[93m";
+    case BLUE:
+        return "\033[94m";
+    case MAGENTA:
+        return "\033[95m";
+    case CYAN:
+        return "\033[96m";
+    case WHITE:
+        return "\033[97m";
+    default:
+        return "\033[0m";
+    }
+}
+
+void frameColor(int color)
+{
+    if (frameActive)
+    {
+        const char *sequence = ansiColor(color);
+        bufferAppend(&frameBuffer, sequence, strlen(sequence));
+    }
+    else
+    {
+        setColor(color);
+    }
+}
+#else
+void frameColor(const char *color)
+{
+    if (frameActive)
+    {
+        bufferAppend(&frameBuffer, color, strlen(color));
+    }
+    else
+    {
+        setColor(color);
+    }
+}
+#endif
+
+void terminalSize(int *rows, int *columns)
+{
+    *rows = 24;
+    *columns = 80;
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info))
+    {
+        *rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+        *columns = info.srWindow.Right - info.srWindow.Left + 1;
+    }
+#else
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0)
+    {
+        *rows = size.ws_row;
+        *columns = size.ws_col;
+    }
+#endif
+}
+
+// Columns a line occupies: skips ANSI sequences and UTF-8 continuation
+// bytes, and expands tabs to the next multiple of eight
+int lineWidth(const char *line, size_t length)
+{
+    int width = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        unsigned char c = (unsigned char)line[i];
+        if (c == '\033' && i + 1 < length && line[i + 1] == '[')
+        {
+            i += 2;
+            while (i < length && (line[i] < 0x40 || line[i] > 0x7e))
+            {
+                i++;
+            }
+        }
+        else if (c == '\t')
+        {
+            width = (width / 8 + 1) * 8;
+        }
+        else if ((c & 0xc0) != 0x80)
+        {
+            width++;
+        }
+    }
+    return width;
+}
+
+// Splits a frame into lines. starts[i] is where line i begins; colors[i] is
+// the last color sequence set before it, so a line redrawn on its own gets
+// the same color it had as part of the whole frame
+int frameLines(FrameBuffer *buffer, size_t **starts, size_t **colors, size_t **colorLengths)
+{
+    int count = 1;
+    for (size_t i = 0; i < buffer->length; i++)
+    {
+        count += buffer->data[i] == '\n';
+    }
+
+    *starts = (size_t *)malloc((count + 1) * sizeof(size_t));
+    *colors = (size_t *)malloc(count * sizeof(size_t));
+    *colorLengths = (size_t *)malloc(count * sizeof(size_t));
+    if (*starts == NULL || *colors == NULL || *colorLengths == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t color = 0, colorLength = 0;
+    int line = 0;
+    (*starts)[0] = 0;
+    (*colors)[0] = 0;
+    (*colorLengths)[0] = 0;
+    for (size_t i = 0; i < buffer->length; i++)
+    {
+        if (buffer->data[i] == '\033' && i + 1 < buffer->length && buffer->data[i + 1] == '[')
+        {
+            size_t end = i + 2;
+            while (end < buffer->length && (buffer->data[end] < 0x40 || buffer->data[end] > 0x7e))
+            {
+                end++;
+            }
+            if (end < buffer->length && buffer->data[end] == 'm')
+            {
+                color = i;
+                colorLength = end + 1 - i;
+            }
+        }
+        else if (buffer->data[i] == '\n')
+        {
+            line++;
+            (*starts)[line] = i + 1;
+            (*colors)[line] = color;
+            (*colorLengths)[line] = colorLength;
+        }
+    }
+    (*starts)[count] = buffer->length + 1; // As if the text ended with '\n'
+    return count;
+}
+
+void terminalWrite(const char *data, size_t length)
+{
+#ifdef _WIN32
+    fwrite(data, 1, length, stdout);
+    fflush(stdout);
+#else
+    while (length > 0)
+    {
+        ssize_t written = write(STDOUT_FILENO, data, length);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        length -= written;
+    }
+#endif
+}
+
+// Puts the composed frame on screen. Lines identical to the frame already
+// shown (text and color) are skipped; a full redraw happens after clear(),
+// after a key prompt, or when the frame would not fit the terminal
+void frameFlush()
+{
+    frameActive = 0;
+    fflush(stdout); // Anything printed directly must reach the screen first
+
+#ifdef _WIN32
+    if (!virtualTerminalEnabled)
+    {
+        HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD mode = 0;
+        if (GetConsoleMode(console, &mode))
+        {
+            SetConsoleMode(console, mode | 0x0004); // ENABLE_VIRTUAL_TERMINAL_PROCESSING
+        }
+        virtualTerminalEnabled = 1;
+    }
+#endif
+
+    int rows, columns;
+    terminalSize(&rows, &columns);
+
+    size_t *starts, *colors, *colorLengths;
+    size_t *oldStarts, *oldColors, *oldColorLengths;
+    int count = frameLines(&frameBuffer, &starts, &colors, &colorLengths);
+    int oldCount = frameLines(&shownFrame, &oldStarts, &oldColors, &oldColorLengths);
+
+    // Row numbers only match frame lines if no line wraps and nothing printed
+    // below the frame can scroll it off the top
+    int fits = count + FRAME_SCROLL_MARGIN <= rows;
+    for (int i = 0; i < count && fits; i++)
+    {
+        fits = lineWidth(frameBuffer.data + starts[i], starts[i + 1] - 1 - starts[i]) < columns;
+    }
+
+    frameOutput.length = 0;
+    if (!frameValid || !fits)
+    {
+        bufferAppend(&frameOutput, "\033[0m\033[H\033[2J", 11);
+        bufferAppend(&frameOutput, frameBuffer.data, frameBuffer.length);
+    }
+    else
+    {
+        for (int i = 0; i < count; i++)
+        {
+            size_t length = starts[i + 1] - 1 - starts[i];
+            const char *line = frameBuffer.data + starts[i];
+            const char *color = frameBuffer.data + colors[i];
+
+            // The last line always gets rewritten: it holds the prompt and
+            // whatever was typed after it, and leaves the cursor in place
+            int changed = i == count - 1 || i >= oldCount;
+            if (!changed)
+            {
+                size_t oldLength = oldStarts[i + 1] - 1 - oldStarts[i];
+                changed = oldLength != length ||
+                          memcmp(shownFrame.data + oldStarts[i], line, length) != 0 ||
+                          oldColorLengths[i] != colorLengths[i] ||
+                          memcmp(shownFrame.data + oldColors[i], color, colorLengths[i]) != 0;
+            }
+            if (changed)
+            {
+                bufferPrintf(&frameOutput, "\033[%d;1H\033[0m\033[2K", i + 1);
+                bufferAppend(&frameOutput, color, colorLengths[i]);
+                bufferAppend(&frameOutput, line, length);
+            }
+        }
+        bufferAppend(&frameOutput, "\033[J", 3); // Erase old frame lines and messages below
+    }
+    terminalWrite(frameOutput.data, frameOutput.length);
+
+    free(starts);
+    free(colors);
+    free(colorLengths);
+    free(oldStarts);
+    free(oldColors);
+    free(oldColorLengths);
+
+    FrameBuffer shown = shownFrame;
+    shownFrame = frameBuffer;
+    frameBuffer = shown;
+    frameValid = fits;
+}
+
+// Viewport Functions-------------------------------------------------------------------
+// The visualizations draw only what fits on screen, starting at a position
+// chosen from the demo menus; the rest is summarized as "... N more"
+long long listViewOffset = 0; // First list element shown
+int stackViewOffset = 0;      // Elements skipped below the top of the stack
+int queueViewOffset = 0;      // Elements skipped after the front of the queue
+int treeViewFocused = 0;      // Show the subtree under treeViewKey
+int treeViewKey = 0;
+
+// Screen rows a visualization may use, after `reserved` rows of menus
+int viewRows(int reserved)
+{
+    int rows, columns;
+    terminalSize(&rows, &columns);
+    rows -= reserved + FRAME_SCROLL_MARGIN;
+    return rows > 4 ? rows : 4;
+}
+
+// Screen columns a one-line visualization may use after its tab indent
+int viewColumns()
+{
+    int rows, columns;
+    terminalSize(&rows, &columns);
+    columns -= 8;
+    return columns > 40 ? columns : 40;
+}
+
+// 12345 as "12,345"
+const char *formatCount(char *buffer, size_t length, long long count)
+{
+    char digits[32];
+    int n = snprintf(digits, sizeof(digits), "%lld", count < 0 ? -count : count);
+    size_t at = 0;
+    if (count < 0 && at + 1 < length)
+    {
+        buffer[at++] = '-';
+    }
+    for (int i = 0; i < n && at + 1 < length; i++)
+    {
+        if (i > 0 && (n - i) % 3 == 0 && at + 1 < length)
+        {
+            buffer[at++] = ',';
+        }
+        buffer[at++] = digits[i];
+    }
+    buffer[at] = '\0';
+    return buffer;
+}
+
+// Asks for a new viewport position; returns 0 on invalid input
+int readViewOffset(const char *prompt, long long *offset)
+{
+    printf("%s", prompt);
+    if (scanf("%lld", offset) != 1 || *offset < 0)
+    {
+        while (getchar() != '\n')
+            ;
+        printf("\t\tInvalid input!\n");
+        SLEEP(1000);
+        return 0;
+    }
+    return 1;
+}
+
 // Typing animation effect
 void typewriter(const char *text, int delay)
 {
@@ -127,6 +601,203 @@ void loadingAnimation(const char *message, int duration)
     printf("\t\r%s [####################] 100%%\n", message);
 }
 
+// Monotonic clock in nanoseconds, used by the batch and benchmark modes
+long long nowNanos()
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (long long)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+// Small xorshift generator so benchmark keys do not depend on RAND_MAX,
+// which is only 32767 on Windows
+unsigned long long nextRandom(unsigned long long *state)
+{
+    unsigned long long x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+// Tracing Functions--------------------------------------------------------------------
+
+// Operation tracing for --trace. Each traced call records one event (name,
+// start, duration) in a ring owned by the calling thread, so recording takes
+// no lock and no atomic read-modify-write; the owner publishes each event
+// with a release store of its count. When a ring is full the oldest events
+// are overwritten, which keeps the most recent TRACE_RING_EVENTS per thread.
+// traceFlush writes them as Chrome trace JSON once the traced work is done.
+// Build with -DDS_TRACE=0 to compile the hooks out; otherwise a disabled
+// trace costs one test of traceEnabled per call
+#ifndef DS_TRACE
+#define DS_TRACE 1
+#endif
+
+#define TRACE_RING_EVENTS 65536 // Per thread; a power of two
+#define TRACE_MAX_THREADS 128   // Threads that start tracing later are not recorded
+
+typedef struct
+{
+    const char *name; // String literal naming the operation
+    long long start;  // nowNanos() at entry
+    long long duration;
+} TraceEvent;
+
+typedef struct
+{
+    atomic_llong written; // Events ever recorded; only the owner stores it
+    int tid;
+    TraceEvent *events;
+} TraceRing;
+
+int traceEnabled = 0;
+long long traceOrigin = 0; // Timestamps are written relative to this
+_Atomic(TraceRing *) traceRings[TRACE_MAX_THREADS];
+atomic_int traceRingCount = 0;
+atomic_llong traceLostThreads = 0;
+_Thread_local TraceRing *threadTraceRing = NULL;
+
+#if DS_TRACE
+#define TRACE_BEGIN() long long traceStart = traceEnabled ? nowNanos() : 0
+#define TRACE_END(name)                    \
+    do                                     \
+    {                                      \
+        if (traceEnabled)                  \
+        {                                  \
+            traceRecord(name, traceStart); \
+        }                                  \
+    } while (0)
+#else
+#define TRACE_BEGIN() ((void)0)
+#define TRACE_END(name) ((void)(name))
+#endif
+
+// Gives the calling thread its ring on its first event; NULL once every
+// slot is taken
+TraceRing *traceAttach()
+{
+    int slot = atomic_fetch_add(&traceRingCount, 1);
+    if (slot >= TRACE_MAX_THREADS)
+    {
+        atomic_fetch_add(&traceLostThreads, 1);
+        return NULL;
+    }
+
+    TraceRing *ring = (TraceRing *)malloc(sizeof(TraceRing));
+    TraceEvent *events = (TraceEvent *)malloc(TRACE_RING_EVENTS * sizeof(TraceEvent));
+    if (ring == NULL || events == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    atomic_init(&ring->written, 0);
+    ring->tid = slot + 1;
+    ring->events = events;
+    atomic_store_explicit(&traceRings[slot], ring, memory_order_release);
+    return ring;
+}
+
+void traceRecord(const char *name, long long start)
+{
+    long long end = nowNanos();
+    TraceRing *ring = threadTraceRing;
+    if (ring == NULL)
+    {
+        ring = threadTraceRing = traceAttach();
+        if (ring == NULL)
+        {
+            return;
+        }
+    }
+
+    long long index = atomic_load_explicit(&ring->written, memory_order_relaxed);
+    TraceEvent *event = &ring->events[index & (TRACE_RING_EVENTS - 1)];
+    event->name = name;
+    event->start = start;
+    event->duration = end - start;
+    atomic_store_explicit(&ring->written, index + 1, memory_order_release);
+}
+
+void startTracing()
+{
+    traceOrigin = nowNanos();
+    traceEnabled = 1;
+}
+
+// Writes every ring as Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+// to path, '-' meaning stdout, and frees the rings. Call it only after the
+// traced threads have finished. Returns 0 on success
+int traceFlush(const char *path)
+{
+    FILE *out = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "Cannot write trace to '%s'\n", path);
+        return 1;
+    }
+
+    traceEnabled = 0;
+    int rings = atomic_load(&traceRingCount);
+    rings = rings < TRACE_MAX_THREADS ? rings : TRACE_MAX_THREADS;
+    long long events = 0, overwritten = 0;
+
+    fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    fprintf(out, "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"data_structures\"}}");
+    for (int r = 0; r < rings; r++)
+    {
+        TraceRing *ring = atomic_load_explicit(&traceRings[r], memory_order_acquire);
+        if (ring == NULL)
+        {
+            continue;
+        }
+        long long written = atomic_load_explicit(&ring->written, memory_order_acquire);
+        long long first = written > TRACE_RING_EVENTS ? written - TRACE_RING_EVENTS : 0;
+        overwritten += first;
+
+        fprintf(out, ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                     "\"args\": {\"name\": \"%s %d\"}}",
+                ring->tid, ring->tid == 1 ? "main" : "worker", ring->tid);
+        for (long long i = first; i < written; i++)
+        {
+            TraceEvent *event = &ring->events[i & (TRACE_RING_EVENTS - 1)];
+            fprintf(out, ",\n  {\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                         "\"ts\": %.3f, \"dur\": %.3f}",
+                    event->name, ring->tid, (event->start - traceOrigin) / 1e3, event->duration / 1e3);
+        }
+        events += written - first;
+
+        atomic_store(&traceRings[r], NULL);
+        free(ring->events);
+        free(ring);
+    }
+    fprintf(out, "\n]}\n");
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    fprintf(stderr, "Traced %lld events on %d thread(s)", events, rings);
+    if (overwritten > 0)
+    {
+        fprintf(stderr, ", %lld older ones overwritten", overwritten);
+    }
+    if (atomic_load(&traceLostThreads) > 0)
+    {
+        fprintf(stderr, ", %lld thread(s) over the limit not recorded", atomic_load(&traceLostThreads));
+    }
+    fprintf(stderr, "\n");
+    return 0;
+}
+
 // Data Structure Definitions
 
 // Node for linked list
@@ -136,31 +807,517 @@ typedef struct Node
     struct Node *next;
 } Node;
 
-// Stack structure
+// Linked list handle: the tail pointer makes appends O(1) and the length
+// is known without walking the list
+typedef struct
+{
+    Node *head;
+    Node *tail;
+    long long length;
+} LinkedList;
+
+// Unrolled list: each chunk holds up to UNROLLED_CAPACITY values in order,
+// so a scan takes one cache miss per chunk instead of one per value. With
+// its next pointer and count a chunk is exactly 128 bytes, two cache lines
+#define UNROLLED_CAPACITY 29
+#define UNROLLED_MIN_FILL (UNROLLED_CAPACITY / 2) // Emptier chunks merge or borrow
+
+typedef struct ListChunk
+{
+    struct ListChunk *next;
+    int count;
+    int values[UNROLLED_CAPACITY];
+} ListChunk;
+
+typedef struct
+{
+    ListChunk *head;
+    ListChunk *tail;
+    long long length;
+    long long chunks;
+} UnrolledList;
+
+// Linked list engines, selectable at runtime like the tree engines
+#define LIST_MODE_NODES 0    // One value per Node
+#define LIST_MODE_UNROLLED 1 // Up to UNROLLED_CAPACITY values per ListChunk
+
+int listMode = LIST_MODE_NODES;
+
+// Skip list: a sorted set whose nodes sit on a random number of levels,
+// each level an express lane over the one below. With p = 1/4 a node
+// averages 1.33 next pointers, and search, insert and delete take O(log n)
+// expected steps with no rotations, which keeps them local enough to run
+// lock-free (see LfSkipList)
+#define SKIP_MAX_LEVEL 24 // Enough for 4^24 keys
+
+typedef struct SkipNode
+{
+    int key;
+    int level;               // Number of next pointers
+    struct SkipNode *next[]; // next[i] is the successor on level i
+} SkipNode;
+
+typedef struct
+{
+    SkipNode *head; // Keyless sentinel with SKIP_MAX_LEVEL pointers
+    int level;      // Levels in use
+    long long length;
+    unsigned long long seed; // Level generator state
+} SkipList;
+
+// Stack structure. The array doubles when full; with autoShrink set it
+// halves once a quarter full (never below minCapacity), so alternating
+// push/pop at a boundary cannot thrash
 typedef struct
 {
     int *array;
     int top;
     int capacity;
+    int minCapacity;
+    int autoShrink;
+    void *mapping; // Snapshot the array lives in (zero-copy load), else NULL
+    size_t mappingLength;
 } Stack;
 
-// Queue structure
+// Queue structure: circular buffer that grows and shrinks like Stack
 typedef struct
 {
     int *array;
     int front;
     int rear;
     int capacity;
+    int minCapacity;
+    int autoShrink;
+    void *mapping; // Snapshot the array lives in (zero-copy load), else NULL
+    size_t mappingLength;
 } Queue;
 
-// Binary Tree Node
-typedef struct TreeNode
+// Priority queue: min-heap in an array with four children per slot, so it is
+// half as deep as a binary heap and a slot's children sit side by side. Each
+// entry carries a caller's id; position[id] is that id's slot (-1 when not
+// queued), which is how decrease-key finds an entry without searching. The
+// index has a slot per id up to the largest pushed, so ids are capped at
+// HEAP_MAX_ID to bound it (64 MB); callers with sparse ids should map them
+// to dense ones first
+#define HEAP_ARITY 4
+#define HEAP_MAX_ID ((1 << 24) - 1)
+
+typedef struct
+{
+    int key;
+    int id;
+} HeapEntry;
+
+typedef struct
+{
+    HeapEntry *entries;
+    int count;
+    int capacity;
+    int *position;
+    int idCapacity;
+} PriorityQueue;
+
+#define CACHE_LINE_SIZE 64
+
+#ifndef _WIN32
+// Lock-free single-producer/single-consumer ring buffer. Capacity is a power
+// of two so indices wrap with a mask, and head/tail grow without bound
+// instead of using -1 sentinels. Each side keeps a cached copy of the other
+// side's index and publishes its own in batches, so the shared cache lines
+// move between cores once per batch instead of once per item
+
+typedef struct
+{
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t head; // Written by the consumer
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t tail; // Written by the producer
+    _Alignas(CACHE_LINE_SIZE) size_t tailLocal;   // Producer: next slot to write
+    size_t headCache;                             // Producer: last head seen
+    _Alignas(CACHE_LINE_SIZE) size_t headLocal;   // Consumer: next slot to read
+    size_t tailCache;                             // Consumer: last tail seen
+    _Alignas(CACHE_LINE_SIZE) int *array;
+    size_t mask;
+    size_t publishBatch;
+} SpscQueue;
+
+// Bounded multi-producer/multi-consumer ring (Vyukov). Every cell carries a
+// sequence number telling whose turn it is, so producers and consumers each
+// claim a slot with one CAS on their own index and never share a lock
+typedef struct
+{
+    atomic_size_t sequence;
+    int data;
+} MpmcCell;
+
+typedef struct
+{
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t enqueuePos;
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t dequeuePos;
+    _Alignas(CACHE_LINE_SIZE) MpmcCell *cells;
+    size_t mask;
+} MpmcQueue;
+
+// Unbounded Michael-Scott linked queue. Dequeued nodes are reclaimed with
+// hazard pointers: every thread attaches a HazardRecord, publishes the nodes
+// it is about to read there, and frees retired nodes only once no record
+// still points at them
+#define HAZARD_MAX_THREADS 64
+#define HAZARD_PER_THREAD 2
+#define HAZARD_SCAN_THRESHOLD 256 // Retired nodes collected before a scan
+
+typedef struct MsNode
+{
+    _Atomic(struct MsNode *) next;
+    int data;
+} MsNode;
+
+typedef struct
+{
+    _Alignas(CACHE_LINE_SIZE) _Atomic(MsNode *) hazard[HAZARD_PER_THREAD];
+    atomic_int active;
+    MsNode **retired;
+    int retiredCount;
+} HazardRecord;
+
+typedef struct
+{
+    _Alignas(CACHE_LINE_SIZE) _Atomic(MsNode *) head;
+    _Alignas(CACHE_LINE_SIZE) _Atomic(MsNode *) tail;
+    HazardRecord records[HAZARD_MAX_THREADS];
+} MsQueue;
+
+// Lock-free Treiber stack over a fixed array of nodes. Heads hold a node
+// index in the low 32 bits and a tag in the high 32 bits that changes on
+// every update, so a CAS cannot succeed against a head that was popped and
+// pushed back in between (the ABA problem). Unused nodes sit on a second
+// Treiber stack, which doubles as a shared free list
+#define TREIBER_NIL 0xffffffffu
+#define ELIMINATION_OFFER (1ull << 32) // Slot holds a pusher's value
+#define ELIMINATION_TAKEN (2ull << 32) // A popper took it; pusher resets
+#define ELIMINATION_SPINS 128          // How long a pusher waits for a popper
+
+typedef struct
+{
+    int data;
+    _Atomic uint32_t next;
+} TreiberNode;
+
+// Collision slot where a push that lost a CAS race can hand its value
+// straight to a pop that lost one too, without touching the head at all
+typedef struct
+{
+    _Alignas(CACHE_LINE_SIZE) _Atomic uint64_t value;
+} EliminationSlot;
+
+typedef struct
+{
+    _Alignas(CACHE_LINE_SIZE) _Atomic uint64_t head;
+    _Alignas(CACHE_LINE_SIZE) _Atomic uint64_t freeHead;
+    _Alignas(CACHE_LINE_SIZE) TreiberNode *nodes;
+    uint32_t capacity;
+    EliminationSlot *elimination;
+    int eliminationSize; // 0 disables elimination
+} TreiberStack;
+
+// Lock-free skip list (Herlihy and Shavit). Every level is a Harris list:
+// bit 0 of a next word marks its node deleted on that level, so no CAS can
+// link behind a node that is being removed. Removal marks the upper levels
+// top-down and level 0 last; whoever marks level 0 owns the removal. Other
+// threads may still be reading a removed node, so it is retired to a list
+// that is freed with the skip list rather than right away
+#define SKIP_MARK ((uintptr_t)1)
+#define SKIP_NODE(word) ((LfSkipNode *)((word) & ~SKIP_MARK))
+
+typedef struct LfSkipNode
+{
+    int key;
+    int level;
+    struct LfSkipNode *retiredNext;
+    _Atomic uintptr_t next[]; // Successor on each level, plus the mark bit
+} LfSkipNode;
+
+typedef struct
+{
+    LfSkipNode *head;
+    _Alignas(CACHE_LINE_SIZE) _Atomic(LfSkipNode *) retired;
+} LfSkipList;
+#endif
+
+// Binary Tree Node
+typedef struct TreeNode
 {
     int data;
+    int height; // Subtree height, kept up to date in AVL mode (fills padding)
     struct TreeNode *left;
     struct TreeNode *right;
 } TreeNode;
 
+// Largest subtree size spelled out in a collapsed tree view
+#define TREE_VIEW_COUNT_CAP 10000
+
+// Searches lookupMany keeps in flight at once. Each one waits on its own
+// cache miss, so eight overlap roughly as many as a core can track
+#define TREE_LOOKUP_LANES 8
+
+// Hint that address will be read soon; a no-op where the builtin is missing
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address) ((void)(address))
+#endif
+
+// Traversal orders understood by the tree cursor
+#define TREE_ORDER_INORDER 0
+#define TREE_ORDER_PREORDER 1
+#define TREE_ORDER_POSTORDER 2
+#define TREE_ORDER_LEVEL 3
+
+// Pull-style iterator over a binary tree. Keeps its own stack (or queue, for
+// level order) on the heap, so deep trees cannot overflow the C stack, and
+// performs no I/O: each call to treeCursorNext yields one key
+typedef struct
+{
+    int order;
+    TreeNode *current;     // Inorder/postorder: subtree still to descend into
+    TreeNode *lastVisited; // Postorder: tells a finished right subtree apart
+    TreeNode **nodes;      // Pending nodes: a stack, or a queue in level order
+    long long head;        // Level order: index of the queue front
+    long long count;       // Stack depth, or one past the queue back
+    long long capacity;
+} TreeCursor;
+
+// Map/reduce visitor for parallelTreeReduce. Every worker folds the keys it
+// visits into its own partial result (partialSize bytes, prepared by init),
+// and merge combines the partials at the end, so visit needs no locking
+typedef struct
+{
+    size_t partialSize;
+    void (*init)(void *partial, void *context);
+    void (*visit)(void *partial, int key, void *context);
+    void (*merge)(void *into, void *from, void *context);
+    void *context;
+} TreeReducer;
+
+// Partial for the summary reducer: count, sum, min and max in one pass
+typedef struct
+{
+    long long count;
+    long long sum;
+    int min;
+    int max;
+} TreeSummary;
+
+// Context for the histogram reducer, whose partial is `buckets` long long
+// counters for equal-width buckets over [low, high]
+typedef struct
+{
+    int low;
+    int high;
+    int buckets;
+} TreeHistogram;
+
+// Partial for the filter reducer: the kept keys, in no particular order
+typedef struct
+{
+    int *keys;
+    long long count;
+    long long capacity;
+} KeyArray;
+
+// Context for the filter reducer
+typedef struct
+{
+    int (*keep)(int key, void *context);
+    void *context;
+} TreeFilter;
+
+// Work-stealing pool for parallel tree walks. A task is a whole subtree.
+// Each worker owns a Chase-Lev deque: it pushes and pops at the bottom with
+// no atomic read-modify-write in the common case, while idle workers steal
+// from the top, where the oldest and therefore largest subtrees sit
+#define WORK_DEQUE_CAPACITY 256     // Power of two
+#define TREE_PARALLEL_GRAIN 4096    // Nodes a task walks alone before sharing
+#define TREE_PARALLEL_MAX_THREADS 64
+
+typedef struct
+{
+    _Alignas(CACHE_LINE_SIZE) atomic_llong top;    // Advanced by thieves (CAS)
+    _Alignas(CACHE_LINE_SIZE) atomic_llong bottom; // Written only by the owner
+    _Alignas(CACHE_LINE_SIZE) _Atomic(TreeNode *) tasks[WORK_DEQUE_CAPACITY];
+} WorkDeque;
+
+typedef struct
+{
+    _Alignas(CACHE_LINE_SIZE) atomic_llong pending; // Tasks queued or running
+    WorkDeque *deques;
+    char *partials; // One per worker, each on its own cache lines
+    size_t stride;
+    int workers;
+    TreeReducer *reducer;
+} WorkPool;
+
+typedef struct
+{
+    WorkPool *pool;
+    int id;
+    TreeNode **stack; // Subtrees this worker still has to walk itself
+    long long capacity;
+    unsigned long long seed; // Picks steal victims
+} TreeWorker;
+
+// Binary tree engines, selectable at runtime
+#define TREE_MODE_BST 0 // Plain unbalanced binary search tree
+#define TREE_MODE_AVL 1 // Height-balanced AVL tree, O(log n) guaranteed
+#define TREE_MODE_BPLUS 2 // Cache-friendly B+ tree with wide nodes
+
+int treeMode = TREE_MODE_BST;
+
+// B+ tree node: up to BPLUS_ORDER sorted keys (two cache lines of ints).
+// Inner node child i holds keys < keys[i], child i+1 keys >= keys[i];
+// leaves are chained through next for in-order range scans
+#define BPLUS_ORDER 32
+#define BPLUS_MIN_KEYS (BPLUS_ORDER / 2)
+
+typedef struct BPlusNode
+{
+    int isLeaf;
+    int count;
+    int keys[BPLUS_ORDER];
+} BPlusNode;
+
+typedef struct
+{
+    BPlusNode node;
+    BPlusNode *next;
+} BPlusLeaf;
+
+typedef struct
+{
+    BPlusNode node;
+    BPlusNode *children[BPLUS_ORDER + 1];
+} BPlusInner;
+
+#define BPLUS_NEXT(n) (((BPlusLeaf *)(n))->next)
+#define BPLUS_CHILDREN(n) (((BPlusInner *)(n))->children)
+
+// Fixed-size object pool: nodes are carved out of large slabs instead of
+// one malloc each, recycled through an intrusive free list, and released
+// all at once. Each node type has its own pool so a structure's nodes stay
+// packed together in memory. Object sizes are rounded up to 8 bytes, not
+// 16, so a 24-byte TreeNode takes 24: every object is 8-byte aligned, enough
+// for the pooled types, and only the first of a slab is 16-byte aligned
+#define POOL_SLAB_OBJECTS 4096
+#define POOL_SLAB_HEADER 16 // Keeps malloc's 16-byte alignment for the first object
+
+typedef struct PoolSlab
+{
+    struct PoolSlab *next;
+} PoolSlab;
+
+typedef struct
+{
+    size_t objectSize;
+    PoolSlab *slabs;       // Every slab owned by the pool, oldest first
+    PoolSlab *currentSlab; // Slab being carved up
+    PoolSlab *lastSlab;
+    char *cursor;          // Next never-used object in currentSlab
+    char *limit;
+    void *freeList;        // Objects handed back by poolFree
+} NodePool;
+
+#define POOL_INIT(type) {(sizeof(type) + 7) & ~(size_t)7, NULL, NULL, NULL, NULL, NULL, NULL}
+
+NodePool listNodePool = POOL_INIT(Node);
+NodePool listChunkPool = POOL_INIT(ListChunk);
+NodePool treeNodePool = POOL_INIT(TreeNode);
+
+// Set by tree insert workers so createTreeNode uses their private pool
+// instead of the shared one, which is not thread-safe
+_Thread_local NodePool *threadTreePool = NULL;
+
+// Instrumentation counters, bumped by STAT_ADD at the points that explain
+// latency: search path lengths, allocations, full and empty structures.
+// Build with -DDS_STATS=0 and every STAT_ADD compiles to nothing; the
+// stats panel and --stats then report zeros and say so
+#ifndef DS_STATS
+#define DS_STATS 1
+#endif
+
+#define STAT_LIST 0  // Node and ListChunk
+#define STAT_STACK 1 // Stack and its array
+#define STAT_QUEUE 2 // Queue and its array
+#define STAT_TREE 3  // TreeNode and BPlusNode
+#define STAT_SKIP 4  // SkipNode and LfSkipNode
+#define STAT_STRUCTURES 5
+
+typedef struct
+{
+    long long treeInserts; // insertTreeNode calls, BST and AVL
+    long long treeInsertComparisons;
+    long long treeInsertVisits;
+    long long listDeletes; // deleteNode and unrolledDelete calls
+    long long listDeleteComparisons;
+    long long listDeleteVisits; // Nodes, or chunks when unrolled
+    long long stackFull;        // Pushes that found the array full and grew it
+    long long stackEmpty;       // Pops rejected on an empty stack
+    long long queueFull;
+    long long queueEmpty;
+    long long allocations[STAT_STRUCTURES];
+    long long bytes[STAT_STRUCTURES];
+    long long treeSize; // Gauges, set by recordTreeShape
+    int treeHeight;
+} DsStats;
+
+// Per thread, so counting needs no atomics; parallelInsertTree folds its
+// workers' counts into the caller's
+_Thread_local DsStats dsStats;
+
+#if DS_STATS
+#define STAT_ADD(field, amount) ((void)(dsStats.field += (amount)))
+#else
+#define STAT_ADD(field, amount) ((void)0)
+#endif
+#define STAT_ALLOC(structure, size) (STAT_ADD(allocations[structure], 1), STAT_ADD(bytes[structure], (long long)(size)))
+
+// Parallel insert: the keys are split by the subtrees hanging below the top
+// levels of the tree ("slots"), and each slot is filled by one worker with
+// no locking, since no two slots share a node
+#define TREE_INSERT_SLOTS_PER_THREAD 8 // Spare slots even out uneven ones
+#define TREE_INSERT_MIN_KEYS 4096      // Per thread; smaller batches go sequential
+#define TREE_INSERT_COUNT 0
+#define TREE_INSERT_SCATTER 1
+#define TREE_INSERT_BUILD 2
+
+typedef struct
+{
+    TreeNode **link;
+    long long low;  // Exclusive key bounds, one past int at the far ends
+    long long high;
+} TreeSlot;
+
+typedef struct
+{
+    int phase;
+    const int *keys;
+    long long begin; // This worker's share of keys for counting and scatter
+    long long end;
+    long long *offsets; // Per slot: key count, then next scatter position
+    TreeSlot *slots;
+    int slotCount;
+    unsigned short *slotOf; // Shared: each key's slot, slotCount if a duplicate
+    int *partitioned;       // Shared: keys grouped by slot
+    long long *slotStart;   // Shared: where each slot's keys begin
+    atomic_int *nextSlot;   // Shared: next slot to claim while building
+    NodePool pool;          // Nodes this worker creates
+    DsStats stats;          // What this worker counted while building
+} InsertWorker;
+
+typedef struct
+{
+    BPlusNode *root;
+    long long size;
+    int height;
+} BPlusTree;
+
 // Function prototypes
 void printHeader();
 void printMenu();
@@ -168,18 +1325,43 @@ void linkedListDemo();
 void stackDemo();
 void queueDemo();
 void binaryTreeDemo();
-void visualizeLinkedList(Node *head);
+void visualizeLinkedList(LinkedList *list);
+void visualizeUnrolledList(UnrolledList *list);
+void visualizeSkipList(SkipList *list);
+void skipListDemo();
+void printKeyAnimated(int key, void *context);
 void visualizeStack(Stack *stack);
 void visualizeQueue(Queue *queue);
-void visualizeBinaryTree(TreeNode *root, int space);
+void priorityQueueDemo();
+void visualizeBinaryTree(TreeNode *root, int space, int depth);
+long long countTreeNodesCapped(TreeNode *root, long long cap);
 void printRetroBox(const char *title, const char *content);
 void flashText(const char *text, int times, int delay);
+int runBatchMode(int argc, char *argv[]);
+void unmapSnapshot(void *base, size_t length);
+int saveListSnapshot(LinkedList *list, UnrolledList *unrolled, const char *path);
+int saveStackSnapshot(Stack *stack, const char *path);
+int saveQueueSnapshot(Queue *queue, const char *path);
+int loadListSnapshot(LinkedList *list, UnrolledList *unrolled, const char *path);
+Stack *loadStackSnapshot(const char *path);
+Queue *loadQueueSnapshot(const char *path);
+int readFilePath(const char *prompt, char *path);
+void reportSnapshot(int ok, int saving, const char *path);
+void statsMerge(DsStats *into, const DsStats *from);
+void recordTreeShape(TreeNode *root, BPlusTree *bplus);
+void showStatsPanel(TreeNode *root, BPlusTree *bplus);
 
 // Main function
-int main()
+int main(int argc, char *argv[])
 {
     int choice;
 
+    // Any command-line argument selects the non-interactive batch mode
+    if (argc > 1)
+    {
+        return runBatchMode(argc, argv);
+    }
+
 #ifdef _WIN32
     system("chcp 65001 > nul");
 #endif
@@ -196,7 +1378,7 @@ int main()
         setColor(CYAN);
 #endif
 
-        printf("\n\tEnter your choice (0-4): ");
+        printf("\n\tEnter your choice (0-5): ");
 
 #ifdef _WIN32
         setColor(RESET);
@@ -227,6 +1409,9 @@ int main()
         case 4:
             binaryTreeDemo();
             break;
+        case 5:
+            showStatsPanel(NULL, NULL);
+            break;
 
         case 0:
             clear();
@@ -303,26 +1488,27 @@ void printMenu()
                   "2. Stack Implementation\n"
                   "3. Queue Implementation\n"
                   "4. Binary Tree Visualization\n"
+                  "5. Instrumentation Stats\n"
                   "0. Exit Program");
 }
 
 void printRetroBox(const char *title, const char *content)
 {
 #ifdef _WIN32
-    setColor(YELLOW);
+    frameColor(YELLOW);
 #else
-    setColor(YELLOW);
+    frameColor(YELLOW);
 #endif
 
     // These extended characters should now display correctly on Windows
-    printf("\n\t┌──────────────────────────────────────────────────────────┐\n");
-    printf("\t│ %-56s │\n", title);
-    printf("\t├──────────────────────────────────────────────────────────┤\n");
+    framePrintf("\n\t┌──────────────────────────────────────────────────────────┐\n");
+    framePrintf("\t│ %-56s │\n", title);
+    framePrintf("\t├──────────────────────────────────────────────────────────┤\n");
 
 #ifdef _WIN32
-    setColor(WHITE);
+    frameColor(WHITE);
 #else
-    setColor(WHITE);
+    frameColor(WHITE);
 #endif
 
     // Split content by lines and print
@@ -333,22 +1519,22 @@ void printRetroBox(const char *title, const char *content)
 
     while (line != NULL)
     {
-        printf("\t│ %-56s │\n", line);
+        framePrintf("\t│ %-56s │\n", line);
         line = strtok(NULL, "\n");
     }
 
 #ifdef _WIN32
-    setColor(YELLOW);
+    frameColor(YELLOW);
 #else
-    setColor(YELLOW);
+    frameColor(YELLOW);
 #endif
 
-    printf("\t└──────────────────────────────────────────────────────────┘\n");
+    framePrintf("\t└──────────────────────────────────────────────────────────┘\n");
 
 #ifdef _WIN32
-    setColor(RESET);
+    frameColor(RESET);
 #else
-    setColor(RESET);
+    frameColor(RESET);
 #endif
 }
 
@@ -385,373 +1571,676 @@ void flashText(const char *text, int times, int delay)
 #endif
 }
 
-// Linked List Functions
-Node *createNode(int data)
+// Memory Pool Functions
+void *poolAlloc(NodePool *pool)
 {
-    Node *newNode = (Node *)malloc(sizeof(Node));
-    if (newNode == NULL)
+    if (pool->freeList != NULL)
     {
-        fprintf(stderr, "Memory allocation failed!\n");
-        exit(EXIT_FAILURE);
+        void *object = pool->freeList;
+        pool->freeList = *(void **)object;
+        return object;
     }
-    newNode->data = data;
-    newNode->next = NULL;
-    return newNode;
-}
 
-void insertNode(Node **head, int data)
-{
-    Node *newNode = createNode(data);
-    if (*head == NULL)
-    {
-        *head = newNode;
-    }
-    else
+    if (pool->cursor == pool->limit)
     {
-        Node *temp = *head;
-        while (temp->next != NULL)
+        // Reuse slabs kept by poolReset before asking malloc for a new one
+        if (pool->currentSlab != NULL && pool->currentSlab->next != NULL)
         {
-            temp = temp->next;
+            pool->currentSlab = pool->currentSlab->next;
+        }
+        else
+        {
+            PoolSlab *slab = (PoolSlab *)malloc(POOL_SLAB_HEADER + POOL_SLAB_OBJECTS * pool->objectSize);
+            if (slab == NULL)
+            {
+                fprintf(stderr, "Memory allocation failed!\n");
+                exit(EXIT_FAILURE);
+            }
+            slab->next = NULL;
+            if (pool->lastSlab != NULL)
+            {
+                pool->lastSlab->next = slab;
+            }
+            else
+            {
+                pool->slabs = slab;
+            }
+            pool->lastSlab = slab;
+            pool->currentSlab = slab;
         }
-        temp->next = newNode;
+        pool->cursor = (char *)pool->currentSlab + POOL_SLAB_HEADER;
+        pool->limit = pool->cursor + POOL_SLAB_OBJECTS * pool->objectSize;
     }
+
+    void *object = pool->cursor;
+    pool->cursor += pool->objectSize;
+    return object;
 }
 
-void deleteNode(Node **head, int data)
+void poolFree(NodePool *pool, void *object)
 {
-    if (*head == NULL)
-        return;
+    *(void **)object = pool->freeList;
+    pool->freeList = object;
+}
 
-    if ((*head)->data == data)
+// Releases every object in O(1) but keeps the slabs for the next structure
+void poolReset(NodePool *pool)
+{
+    pool->freeList = NULL;
+    pool->currentSlab = pool->slabs;
+    pool->cursor = pool->slabs != NULL ? (char *)pool->slabs + POOL_SLAB_HEADER : NULL;
+    pool->limit = pool->slabs != NULL ? pool->cursor + POOL_SLAB_OBJECTS * pool->objectSize : NULL;
+}
+
+// Takes over every slab of `from` as in-use memory and leaves `from` empty,
+// e.g. once worker threads are done filling private pools. The slabs go in
+// front of the one pool is carving, so they are not handed out again until
+// the next reset. Objects on from's free list stay allocated
+void poolAdopt(NodePool *pool, NodePool *from)
+{
+    if (from->slabs == NULL)
     {
-        Node *temp = *head;
-        *head = (*head)->next;
-        free(temp);
         return;
     }
-
-    Node *current = *head;
-    while (current->next != NULL && current->next->data != data)
+    from->lastSlab->next = pool->slabs;
+    if (pool->slabs == NULL)
     {
-        current = current->next;
+        pool->lastSlab = from->lastSlab;
     }
+    pool->slabs = from->slabs;
+
+    from->slabs = from->lastSlab = from->currentSlab = NULL;
+    from->cursor = from->limit = NULL;
+    from->freeList = NULL;
+}
 
-    if (current->next != NULL)
+// Releases every object and returns the slabs to the system
+void poolDestroy(NodePool *pool)
+{
+    while (pool->slabs != NULL)
     {
-        Node *temp = current->next;
-        current->next = current->next->next;
-        free(temp);
+        PoolSlab *next = pool->slabs->next;
+        free(pool->slabs);
+        pool->slabs = next;
     }
+    pool->lastSlab = NULL;
+    poolReset(pool);
+}
+
+// Linked List Functions
+Node *createNode(int data)
+{
+    Node *newNode = (Node *)poolAlloc(&listNodePool);
+    STAT_ALLOC(STAT_LIST, sizeof(Node));
+    newNode->data = data;
+    newNode->next = NULL;
+    return newNode;
 }
 
-void visualizeLinkedList(Node *head)
+// Releases every list node at once; see freeAllTreeNodes
+void freeAllListNodes()
 {
-    printf("\n\tLinked List Visualization:\n");
-    printf("\t");
+    poolDestroy(&listNodePool);
+}
 
-#ifdef _WIN32
-    setColor(CYAN);
-#else
-    setColor(CYAN);
-#endif
+// Same, but keeps the slabs for a list that is about to be refilled
+void resetAllListNodes()
+{
+    poolReset(&listNodePool);
+}
+
+void insertNode(LinkedList *list, int data)
+{
+    TRACE_BEGIN();
+    Node *newNode = createNode(data);
+    if (list->tail == NULL)
+    {
+        list->head = newNode;
+    }
+    else
+    {
+        list->tail->next = newNode;
+    }
+    list->tail = newNode;
+    list->length++;
+    TRACE_END("insertNode");
+}
 
-    Node *current = head;
+void deleteNode(LinkedList *list, int data)
+{
+    TRACE_BEGIN();
+    Node *previous = NULL;
+    Node *current = list->head;
+    STAT_ADD(listDeletes, 1);
     while (current != NULL)
     {
-        printf("[%d]", current->data);
-        if (current->next != NULL)
+        STAT_ADD(listDeleteVisits, 1);
+        STAT_ADD(listDeleteComparisons, 1);
+        if (current->data == data)
         {
-            printf(" -> ");
+            break;
         }
+        previous = current;
         current = current->next;
     }
-    printf(" -> NULL\n");
 
-#ifdef _WIN32
-    setColor(RESET);
-#else
-    setColor(RESET);
-#endif
+    if (current == NULL)
+    {
+        TRACE_END("deleteNode");
+        return;
+    }
+
+    if (previous == NULL)
+    {
+        list->head = current->next;
+    }
+    else
+    {
+        previous->next = current->next;
+    }
+    if (list->tail == current)
+    {
+        list->tail = previous;
+    }
+    list->length--;
+    poolFree(&listNodePool, current);
+    TRACE_END("deleteNode");
 }
 
-void linkedListDemo()
+ListChunk *createListChunk()
 {
-    clear();
-    // printHeader();
-    printRetroBox("Linked List Demonstration",
-                  "This section demonstrates Linked List operations\n"
-                  "with visual animations.");
+    ListChunk *chunk = (ListChunk *)poolAlloc(&listChunkPool);
+    STAT_ALLOC(STAT_LIST, sizeof(ListChunk));
+    chunk->next = NULL;
+    chunk->count = 0;
+    return chunk;
+}
 
-    loadingAnimation("\tInitializing Linked List", 30);
+void freeAllListChunks()
+{
+    poolDestroy(&listChunkPool);
+}
 
-    Node *head = NULL;
-    int choice, value;
+void resetAllListChunks()
+{
+    poolReset(&listChunkPool);
+}
 
-    do
+// Appends data. A full tail starts a new chunk rather than splitting, since
+// nothing is ever inserted mid-list: every chunk but the tail stays full
+void unrolledInsert(UnrolledList *list, int data)
+{
+    if (list->tail == NULL || list->tail->count == UNROLLED_CAPACITY)
     {
-        clear();
-        printRetroBox("Linked List Operations",
-                      "1. Insert Node\n"
-                      "2. Delete Node\n"
-                      "3. Animate Linked List Traversal\n"
-                      "0. Back to Main Menu");
-
-        visualizeLinkedList(head);
-
-#ifdef _WIN32
-        setColor(CYAN);
-#else
-        setColor(CYAN);
-#endif
+        ListChunk *chunk = createListChunk();
+        if (list->tail == NULL)
+        {
+            list->head = chunk;
+        }
+        else
+        {
+            list->tail->next = chunk;
+        }
+        list->tail = chunk;
+        list->chunks++;
+    }
+    list->tail->values[list->tail->count++] = data;
+    list->length++;
+}
 
-        printf("\n\tEnter operation choice: ");
+// Removes the first occurrence of data. A chunk left under UNROLLED_MIN_FILL
+// absorbs its successor if both fit in one chunk, else borrows from it until
+// the two are even, so chunks stay at least half full and scans stay dense
+void unrolledDelete(UnrolledList *list, int data)
+{
+    ListChunk *previous = NULL;
+    ListChunk *chunk = list->head;
+    int position = 0;
+    STAT_ADD(listDeletes, 1);
+    for (; chunk != NULL; previous = chunk, chunk = chunk->next)
+    {
+        for (position = 0; position < chunk->count && chunk->values[position] != data; position++)
+        {
+        }
+        STAT_ADD(listDeleteVisits, 1);
+        STAT_ADD(listDeleteComparisons, position < chunk->count ? position + 1 : chunk->count);
+        if (position < chunk->count)
+        {
+            break;
+        }
+    }
+    if (chunk == NULL)
+    {
+        return;
+    }
 
-#ifdef _WIN32
-        setColor(RESET);
-#else
-        setColor(RESET);
-#endif
+    memmove(&chunk->values[position], &chunk->values[position + 1], (chunk->count - position - 1) * sizeof(int));
+    chunk->count--;
+    list->length--;
 
-        if (scanf("%d", &choice) != 1)
+    ListChunk *next = chunk->next;
+    if (chunk->count == 0)
+    {
+        // Only a lone or tail chunk gets this far, but unlink it either way
+        if (previous == NULL)
         {
-            while (getchar() != '\n')
-                ;
-            choice = -1;
+            list->head = next;
         }
-
-        switch (choice)
+        else
         {
-        case 1:
-            printf("\t\tEnter value to insert: ");
-            if (scanf("%d", &value) != 1)
+            previous->next = next;
+        }
+        if (list->tail == chunk)
+        {
+            list->tail = previous;
+        }
+        poolFree(&listChunkPool, chunk);
+        list->chunks--;
+    }
+    else if (chunk->count < UNROLLED_MIN_FILL && next != NULL)
+    {
+        if (chunk->count + next->count <= UNROLLED_CAPACITY)
+        {
+            memcpy(&chunk->values[chunk->count], next->values, next->count * sizeof(int));
+            chunk->count += next->count;
+            chunk->next = next->next;
+            if (list->tail == next)
             {
-                while (getchar() != '\n')
-                    ;
-                printf("\t\tInvalid input!\n");
-                SLEEP(1000);
-                break;
+                list->tail = chunk;
             }
-            insertNode(&head, value);
-
-#ifdef _WIN32
-            setColor(GREEN);
-#else
-            setColor(GREEN);
-#endif
-
-            printf("\t\tNode with value %d inserted successfully!\n", value);
-
-#ifdef _WIN32
-            setColor(RESET);
-#else
-            setColor(RESET);
-#endif
-
-            SLEEP(1000);
-            break;
-
-        case 2:
-            printf("\t\tEnter value to delete: ");
-            if (scanf("%d", &value) != 1)
-            {
-                while (getchar() != '\n')
-                    ;
-                printf("\t\tInvalid input!\n");
-                SLEEP(1000);
-                break;
-            }
-            deleteNode(&head, value);
-
-#ifdef _WIN32
-            setColor(RED);
-#else
-            setColor(RED);
-#endif
-
-            printf("\t\tNode with value %d deleted if it existed!\n", value);
-
-#ifdef _WIN32
-            setColor(RESET);
-#else
-            setColor(RESET);
-#endif
-
-            SLEEP(1000);
-            break;
+            poolFree(&listChunkPool, next);
+            list->chunks--;
+        }
+        else
+        {
+            int moved = (next->count - chunk->count) / 2;
+            memcpy(&chunk->values[chunk->count], next->values, moved * sizeof(int));
+            memmove(next->values, &next->values[moved], (next->count - moved) * sizeof(int));
+            chunk->count += moved;
+            next->count -= moved;
+        }
+    }
+}
 
-        case 3:
-            printf("\n\t\tAnimating traversal...\n\t\t");
-            Node *current = head;
-            while (current != NULL)
+// Switches the list engine, moving the values across in order
+void setListMode(LinkedList *list, UnrolledList *unrolled, int mode)
+{
+    if (mode == LIST_MODE_UNROLLED && listMode != LIST_MODE_UNROLLED)
+    {
+        for (Node *current = list->head; current != NULL; current = current->next)
+        {
+            unrolledInsert(unrolled, current->data);
+        }
+        freeAllListNodes();
+        list->head = list->tail = NULL;
+        list->length = 0;
+    }
+    else if (mode == LIST_MODE_NODES && listMode != LIST_MODE_NODES)
+    {
+        for (ListChunk *chunk = unrolled->head; chunk != NULL; chunk = chunk->next)
+        {
+            for (int i = 0; i < chunk->count; i++)
             {
-#ifdef _WIN32
-                setColor(GREEN);
-#else
-                setColor(GREEN);
-#endif
-
-                printf("[%d]", current->data);
-                fflush(stdout);
-                SLEEP(300);
-
-                if (current->next != NULL)
-                {
-                    printf(" -> ");
-                    fflush(stdout);
-                    SLEEP(1500);
-                }
-
-                current = current->next;
+                insertNode(list, chunk->values[i]);
             }
-            printf(" -> NULL\n");
-
-#ifdef _WIN32
-            setColor(RESET);
-#else
-            setColor(RESET);
-#endif
-
-            printf("\n\t\tTraversal complete! Press any key...");
-            getch_wrapper();
-            break;
-        case 0:
-            break; // Exit loop
-        default:
-            printf("\t\tInvalid choice!\n");
-            SLEEP(1000);
         }
-    } while (choice != 0);
+        freeAllListChunks();
+        unrolled->head = unrolled->tail = NULL;
+        unrolled->length = unrolled->chunks = 0;
+    }
+    listMode = mode;
+}
 
-    // Free memory
-    while (head != NULL)
+// Skip List Functions
+
+// Level k with probability (3/4)(1/4)^(k-1), two random bits per coin flip
+int randomSkipLevel(unsigned long long *seed)
+{
+    unsigned long long bits = nextRandom(seed);
+    int level = 1;
+    while (level < SKIP_MAX_LEVEL && (bits & 3) == 0)
     {
-        Node *temp = head;
-        head = head->next;
-        free(temp);
+        level++;
+        bits >>= 2;
     }
+    return level;
 }
 
-// Stack Functions
-Stack *createStack(int capacity)
+SkipNode *createSkipNode(int key, int level)
 {
-    Stack *stack = (Stack *)malloc(sizeof(Stack));
-    if (stack == NULL)
+    SkipNode *node = (SkipNode *)malloc(sizeof(SkipNode) + level * sizeof(SkipNode *));
+    if (node == NULL)
     {
         fprintf(stderr, "Memory allocation failed!\n");
         exit(EXIT_FAILURE);
     }
-    stack->capacity = capacity;
-    stack->top = -1;
-    stack->array = (int *)malloc(capacity * sizeof(int));
-    if (stack->array == NULL)
+    STAT_ALLOC(STAT_SKIP, sizeof(SkipNode) + level * sizeof(SkipNode *));
+    node->key = key;
+    node->level = level;
+    for (int i = 0; i < level; i++)
+    {
+        node->next[i] = NULL;
+    }
+    return node;
+}
+
+SkipList *createSkipList()
+{
+    SkipList *list = (SkipList *)malloc(sizeof(SkipList));
+    if (list == NULL)
     {
-        free(stack);
         fprintf(stderr, "Memory allocation failed!\n");
         exit(EXIT_FAILURE);
     }
-    return stack;
+    list->head = createSkipNode(0, SKIP_MAX_LEVEL);
+    list->level = 1;
+    list->length = 0;
+    list->seed = 0x9E3779B97F4A7C15ull;
+    return list;
 }
 
-int isStackEmpty(Stack *stack)
+void freeSkipList(SkipList *list)
 {
-    return stack->top == -1;
+    SkipNode *node = list->head;
+    while (node != NULL)
+    {
+        SkipNode *next = node->next[0];
+        free(node);
+        node = next;
+    }
+    free(list);
 }
 
-int isStackFull(Stack *stack)
+// Fills update[i] with the last node before key on every level in use and
+// returns the first node at or after key
+SkipNode *skipFindPredecessors(SkipList *list, int key, SkipNode **update)
 {
-    return stack->top == stack->capacity - 1;
+    SkipNode *node = list->head;
+    for (int i = list->level - 1; i >= 0; i--)
+    {
+        while (node->next[i] != NULL && node->next[i]->key < key)
+        {
+            node = node->next[i];
+        }
+        update[i] = node;
+    }
+    return node->next[0];
 }
 
-void push(Stack *stack, int item)
+// First node with a key >= key, or NULL
+SkipNode *skipLowerBound(SkipList *list, int key)
 {
-    if (isStackFull(stack))
+    SkipNode *node = list->head;
+    for (int i = list->level - 1; i >= 0; i--)
     {
-        return;
+        while (node->next[i] != NULL && node->next[i]->key < key)
+        {
+            node = node->next[i];
+        }
     }
-    stack->array[++stack->top] = item;
+    return node->next[0];
 }
 
-int pop(Stack *stack)
+// Returns 0 if key is already in the set
+int skipInsert(SkipList *list, int key)
 {
-    if (isStackEmpty(stack))
+    SkipNode *update[SKIP_MAX_LEVEL];
+    SkipNode *next = skipFindPredecessors(list, key, update);
+    if (next != NULL && next->key == key)
     {
-        return -1;
+        return 0;
+    }
+
+    int level = randomSkipLevel(&list->seed);
+    for (; list->level < level; list->level++)
+    {
+        update[list->level] = list->head;
     }
-    return stack->array[stack->top--];
+
+    SkipNode *node = createSkipNode(key, level);
+    for (int i = 0; i < level; i++)
+    {
+        node->next[i] = update[i]->next[i];
+        update[i]->next[i] = node;
+    }
+    list->length++;
+    return 1;
 }
 
-void visualizeStack(Stack *stack)
+int skipSearch(SkipList *list, int key)
 {
-    printf("\n\tStack Visualization (Top to Bottom):\n");
-    printf("\t┌───────┐\n");
+    SkipNode *node = skipLowerBound(list, key);
+    return node != NULL && node->key == key;
+}
+
+// Returns 0 if key was not in the set. The node is unlinked on each of its
+// levels from the predecessors the search passed, no scan needed
+int skipDelete(SkipList *list, int key)
+{
+    SkipNode *update[SKIP_MAX_LEVEL];
+    SkipNode *node = skipFindPredecessors(list, key, update);
+    if (node == NULL || node->key != key)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < node->level; i++)
+    {
+        update[i]->next[i] = node->next[i];
+    }
+    while (list->level > 1 && list->head->next[list->level - 1] == NULL)
+    {
+        list->level--;
+    }
+    list->length--;
+    free(node);
+    return 1;
+}
 
-    for (int i = stack->top; i >= 0; i--)
+// Visits the keys in [low, high] in order; returns how many there were
+long long skipRangeScan(SkipList *list, int low, int high, void (*visit)(int, void *), void *context)
+{
+    long long visited = 0;
+    for (SkipNode *node = skipLowerBound(list, low); node != NULL && node->key <= high; node = node->next[0])
     {
+        visit(node->key, context);
+        visited++;
+    }
+    return visited;
+}
+
+void visualizeLinkedList(LinkedList *list)
+{
+    char count[32];
+    int budget = viewColumns();
+    long long index = 0;
+
+    framePrintf("\n\tLinked List Visualization (length %s):\n", formatCount(count, sizeof(count), list->length));
+    framePrintf("\t");
+
 #ifdef _WIN32
-        setColor(YELLOW);
+    frameColor(CYAN);
 #else
-        setColor(YELLOW);
+    frameColor(CYAN);
 #endif
 
-        printf("\t│ %5d │", stack->array[i]);
+    if (listViewOffset > 0 && list->length > 0)
+    {
+        if (listViewOffset >= list->length)
+        {
+            listViewOffset = list->length - 1;
+        }
+        framePrintf("... %s before -> ", formatCount(count, sizeof(count), listViewOffset));
+        budget -= 20;
+    }
+
+    // Skipping is pointer chasing only; output stays one screen line
+    Node *current = list->head;
+    for (; current != NULL && index < listViewOffset; index++)
+    {
+        current = current->next;
+    }
 
-        if (i == stack->top)
+    char item[24];
+    while (current != NULL)
+    {
+        int width = snprintf(item, sizeof(item), "[%d] -> ", current->data);
+        if (width > budget - 24)
         {
-            printf("  ← TOP");
+            break; // Keep room for the summary
         }
+        framePrintf("%s", item);
+        budget -= width;
+        current = current->next;
+        index++;
+    }
+
+    if (current != NULL)
+    {
+        framePrintf("... %s more -> NULL\n", formatCount(count, sizeof(count), list->length - index));
+    }
+    else
+    {
+        framePrintf("NULL\n");
+    }
+
+#ifdef _WIN32
+    frameColor(RESET);
+#else
+    frameColor(RESET);
+#endif
+}
+
+// Chunks drawn as [a, b, c] -> [d, e] -> NULL, with the same scrolling as
+// visualizeLinkedList; whole chunks are skipped by their counts
+void visualizeUnrolledList(UnrolledList *list)
+{
+    char count[32], chunks[32];
+    int budget = viewColumns();
+    long long index = 0;
 
-        printf("\n");
+    framePrintf("\n\tUnrolled List Visualization (length %s, %s chunks):\n",
+                formatCount(count, sizeof(count), list->length), formatCount(chunks, sizeof(chunks), list->chunks));
+    framePrintf("\t");
 
 #ifdef _WIN32
-        setColor(RESET);
+    frameColor(CYAN);
 #else
-        setColor(RESET);
+    frameColor(CYAN);
 #endif
 
-        printf("\t├───────┤\n");
+    if (listViewOffset > 0 && list->length > 0)
+    {
+        if (listViewOffset >= list->length)
+        {
+            listViewOffset = list->length - 1;
+        }
+        framePrintf("... %s before -> ", formatCount(count, sizeof(count), listViewOffset));
+        budget -= 20;
+    }
+
+    ListChunk *chunk = list->head;
+    while (chunk != NULL && index + chunk->count <= listViewOffset)
+    {
+        index += chunk->count;
+        chunk = chunk->next;
+    }
+    int position = chunk != NULL ? (int)(listViewOffset - index) : 0;
+    index += position;
+
+    char item[24];
+    int full = 0;
+    while (chunk != NULL && !full)
+    {
+        framePrintf("[");
+        budget--;
+        for (; position < chunk->count; position++)
+        {
+            int width = snprintf(item, sizeof(item), position + 1 < chunk->count ? "%d, " : "%d] -> ",
+                                 chunk->values[position]);
+            if (width > budget - 24)
+            {
+                full = 1; // Keep room for the summary
+                break;
+            }
+            framePrintf("%s", item);
+            budget -= width;
+            index++;
+        }
+        if (!full)
+        {
+            chunk = chunk->next;
+            position = 0;
+        }
+    }
+
+    if (chunk != NULL)
+    {
+        framePrintf("... %s more -> NULL\n", formatCount(count, sizeof(count), list->length - index));
+    }
+    else
+    {
+        framePrintf("NULL\n");
     }
 
-    printf("\t└───────┘\n");
+#ifdef _WIN32
+    frameColor(RESET);
+#else
+    frameColor(RESET);
+#endif
 }
 
-void stackDemo()
+void linkedListDemo()
 {
     clear();
-    printHeader();
-    printRetroBox("Stack Implementation",
-                  "This section demonstrates Stack operations\n"
+    // printHeader();
+    printRetroBox("Linked List Demonstration",
+                  "This section demonstrates Linked List operations\n"
                   "with visual animations.");
 
-    loadingAnimation("Initializing Stack", 30);
+    loadingAnimation("\tInitializing Linked List", 30);
 
-    int capacity = 10;
-    Stack *stack = createStack(capacity);
+    LinkedList list = {NULL, NULL, 0};
+    UnrolledList unrolled = {NULL, NULL, 0, 0};
     int choice, value;
 
     do
     {
-        clear();
-
-        printRetroBox("Stack Operations",
-                      "1. Push Element\n"
-                      "2. Pop Element\n"
+        beginFrame();
+        printRetroBox("Linked List Operations",
+                      "1. Insert Node\n"
+                      "2. Delete Node\n"
+                      "3. Animate Linked List Traversal\n"
+                      "4. Scroll View\n"
+                      "5. Save Snapshot\n"
+                      "6. Load Snapshot\n"
+                      "7. Switch List Engine (Nodes / Unrolled)\n"
+                      "8. Skip List (Sorted Set)\n"
                       "0. Back to Main Menu");
 
-        visualizeStack(stack);
+        if (listMode == LIST_MODE_UNROLLED)
+        {
+            visualizeUnrolledList(&unrolled);
+        }
+        else
+        {
+            visualizeLinkedList(&list);
+        }
 
 #ifdef _WIN32
-        setColor(CYAN);
+        frameColor(CYAN);
 #else
-        setColor(CYAN);
+        frameColor(CYAN);
 #endif
 
-        printf("\n\t\tEnter operation choice: ");
+        framePrintf("\n\tEnter operation choice: ");
 
 #ifdef _WIN32
-        setColor(RESET);
+        frameColor(RESET);
 #else
-        setColor(RESET);
+        frameColor(RESET);
 #endif
+        frameFlush();
 
         if (scanf("%d", &choice) != 1)
         {
@@ -763,89 +2252,202 @@ void stackDemo()
         switch (choice)
         {
         case 1:
-            if (isStackFull(stack))
+            printf("\t\tEnter value to insert: ");
+            if (scanf("%d", &value) != 1)
+            {
+                while (getchar() != '\n')
+                    ;
+                printf("\t\tInvalid input!\n");
+                SLEEP(1000);
+                break;
+            }
+            if (listMode == LIST_MODE_UNROLLED)
+            {
+                unrolledInsert(&unrolled, value);
+            }
+            else
             {
+                insertNode(&list, value);
+            }
+
 #ifdef _WIN32
-                setColor(RED);
+            setColor(GREEN);
 #else
-                setColor(RED);
+            setColor(GREEN);
 #endif
 
-                printf("\t\tStack Overflow! Cannot push more elements.\n");
+            printf("\t\tNode with value %d inserted successfully!\n", value);
 
 #ifdef _WIN32
-                setColor(RESET);
+            setColor(RESET);
 #else
-                setColor(RESET);
+            setColor(RESET);
 #endif
+
+            SLEEP(1000);
+            break;
+
+        case 2:
+            printf("\t\tEnter value to delete: ");
+            if (scanf("%d", &value) != 1)
+            {
+                while (getchar() != '\n')
+                    ;
+                printf("\t\tInvalid input!\n");
+                SLEEP(1000);
+                break;
+            }
+            if (listMode == LIST_MODE_UNROLLED)
+            {
+                unrolledDelete(&unrolled, value);
             }
             else
             {
-                printf("\t\tEnter value to push: ");
-                if (scanf("%d", &value) != 1)
-                {
-                    while (getchar() != '\n')
-                        ;
-                    printf("\t\tInvalid input!\n");
-                    SLEEP(1000);
-                    break;
-                }
-                push(stack, value);
+                deleteNode(&list, value);
+            }
 
 #ifdef _WIN32
-                setColor(GREEN);
+            setColor(RED);
 #else
-                setColor(GREEN);
+            setColor(RED);
 #endif
 
-                printf("\t\tValue %d pushed onto stack!\n", value);
+            printf("\t\tNode with value %d deleted if it existed!\n", value);
 
 #ifdef _WIN32
-                setColor(RESET);
+            setColor(RESET);
 #else
-                setColor(RESET);
+            setColor(RESET);
 #endif
-            }
+
             SLEEP(1000);
             break;
 
-        case 2:
-            if (isStackEmpty(stack))
+        case 3:
+            printf("\n\t\tAnimating traversal...\n\t\t");
+            if (listMode == LIST_MODE_UNROLLED)
             {
+                // One pointer hop per chunk: values inside it are adjacent
+                for (ListChunk *chunk = unrolled.head; chunk != NULL; chunk = chunk->next)
+                {
 #ifdef _WIN32
-                setColor(RED);
+                    setColor(GREEN);
 #else
-                setColor(RED);
+                    setColor(GREEN);
 #endif
 
-                printf("\t\tStack Underflow! Stack is empty.\n");
+                    printf("[");
+                    for (int i = 0; i < chunk->count; i++)
+                    {
+                        printf(i > 0 ? ", %d" : "%d", chunk->values[i]);
+                        fflush(stdout);
+                        SLEEP(300);
+                    }
+                    printf("]");
+
+                    if (chunk->next != NULL)
+                    {
+                        printf(" -> ");
+                        fflush(stdout);
+                        SLEEP(1500);
+                    }
+                }
+                printf(" -> NULL\n");
 
 #ifdef _WIN32
                 setColor(RESET);
 #else
                 setColor(RESET);
 #endif
+
+                printf("\n\t\tTraversal complete! Press any key...");
+                getch_wrapper();
+                break;
             }
-            else
+
+            Node *current = list.head;
+            while (current != NULL)
             {
-                value = pop(stack);
+#ifdef _WIN32
+                setColor(GREEN);
+#else
+                setColor(GREEN);
+#endif
+
+                printf("[%d]", current->data);
+                fflush(stdout);
+                SLEEP(300);
+
+                if (current->next != NULL)
+                {
+                    printf(" -> ");
+                    fflush(stdout);
+                    SLEEP(1500);
+                }
+
+                current = current->next;
+            }
+            printf(" -> NULL\n");
 
 #ifdef _WIN32
-                setColor(MAGENTA);
+            setColor(RESET);
 #else
-                setColor(MAGENTA);
+            setColor(RESET);
 #endif
 
-                printf("\t\tValue %d popped from stack!\n", value);
+            printf("\n\t\tTraversal complete! Press any key...");
+            getch_wrapper();
+            break;
+        case 4:
+        {
+            long long offset;
+            if (readViewOffset("\t\tShow from element # (0 = head): ", &offset))
+            {
+                listViewOffset = offset;
+            }
+            break;
+        }
+        case 5:
+        case 6:
+        {
+            char path[256];
+            if (readFilePath("\t\tSnapshot file: ", path))
+            {
+                reportSnapshot(choice == 5 ? saveListSnapshot(&list, &unrolled, path)
+                                           : loadListSnapshot(&list, &unrolled, path),
+                               choice == 5, path);
+            }
+            break;
+        }
+        case 7:
+            setListMode(&list, &unrolled, 1 - listMode);
 
 #ifdef _WIN32
-                setColor(RESET);
+            setColor(GREEN);
 #else
-                setColor(RESET);
+            setColor(GREEN);
 #endif
+
+            if (listMode == LIST_MODE_UNROLLED)
+            {
+                printf("\t\tUnrolled mode on: %d values per 128-byte chunk!\n", UNROLLED_CAPACITY);
             }
+            else
+            {
+                printf("\t\tNode mode on: one value per node.\n");
+            }
+
+#ifdef _WIN32
+            setColor(RESET);
+#else
+            setColor(RESET);
+#endif
+
             SLEEP(1000);
             break;
+        case 8:
+            skipListDemo();
+            break;
         case 0:
             break; // Exit loop
         default:
@@ -854,161 +2456,110 @@ void stackDemo()
         }
     } while (choice != 0);
 
-    free(stack->array);
-    free(stack);
-}
-
-// Queue Functions
-Queue *createQueue(int capacity)
-{
-    Queue *queue = (Queue *)malloc(sizeof(Queue));
-    if (queue == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed!\n");
-        exit(EXIT_FAILURE);
-    }
-    queue->capacity = capacity;
-    queue->front = queue->rear = -1;
-    queue->array = (int *)malloc(capacity * sizeof(int));
-    if (queue->array == NULL)
-    {
-        free(queue);
-        fprintf(stderr, "Memory allocation failed!\n");
-        exit(EXIT_FAILURE);
-    }
-    return queue;
-}
-
-int isQueueEmpty(Queue *queue)
-{
-    return queue->front == -1;
-}
-
-int isQueueFull(Queue *queue)
-{
-    return (queue->rear + 1) % queue->capacity == queue->front;
-}
-
-void enqueue(Queue *queue, int item)
-{
-    if (isQueueFull(queue))
-    {
-        return;
-    }
-
-    if (isQueueEmpty(queue))
-    {
-        queue->front = queue->rear = 0;
-    }
-    else
-    {
-        queue->rear = (queue->rear + 1) % queue->capacity;
-    }
-
-    queue->array[queue->rear] = item;
+    // Free memory
+    freeAllListNodes();
+    freeAllListChunks();
+    listMode = LIST_MODE_NODES;
+    listViewOffset = 0;
 }
 
-int dequeue(Queue *queue)
+// One row per level, top first. A key shows on every level its node
+// reaches, so the express lanes appear as gaps:
+//   L2  HEAD ---------> [20] -> NULL
+//   L1  HEAD -> [10] -> [20] -> NULL
+void visualizeSkipList(SkipList *list)
 {
-    if (isQueueEmpty(queue))
-    {
-        return -1;
-    }
-
-    int item = queue->array[queue->front];
-
-    if (queue->front == queue->rear)
-    {
-        queue->front = queue->rear = -1;
-    }
-    else
-    {
-        queue->front = (queue->front + 1) % queue->capacity;
-    }
-
-    return item;
-}
+    static const char dashes[] = "--------------------------------";
+    SkipNode *columns[64];
+    int widths[64], shown = 0;
+    int budget = viewColumns() - 40; // Tab, level label, HEAD and the summary
+    char count[32], item[24];
 
-void visualizeQueue(Queue *queue)
-{
-    printf("\n\tQueue Visualization:\n");
-    printf("\t");
+    framePrintf("\n\tSkip List Visualization (length %s, %d levels):\n",
+                formatCount(count, sizeof(count), list->length), list->level);
 
-    if (isQueueEmpty(queue))
+    SkipNode *node = list->head->next[0];
+    for (; node != NULL && shown < 64; node = node->next[0])
     {
-        printf("[EMPTY QUEUE]\n");
-        return;
+        int width = snprintf(item, sizeof(item), "-> [%d] ", node->key);
+        if (width > budget)
+        {
+            break;
+        }
+        budget -= width;
+        columns[shown] = node;
+        widths[shown++] = width;
     }
 
 #ifdef _WIN32
-    setColor(YELLOW);
+    frameColor(CYAN);
 #else
-    setColor(YELLOW);
+    frameColor(CYAN);
 #endif
 
-    int i = queue->front;
-    printf("FRONT → ");
-
-    while (1)
+    for (int level = list->level - 1; level >= 0; level--)
     {
-        printf("[%d]", queue->array[i]);
-
-        if (i == queue->rear)
+        framePrintf("\tL%-2d HEAD ", level + 1);
+        for (int i = 0; i < shown; i++)
         {
-            break;
+            if (columns[i]->level > level)
+            {
+                framePrintf("-> [%d] ", columns[i]->key);
+            }
+            else
+            {
+                framePrintf("%.*s", widths[i], dashes);
+            }
+        }
+        if (node != NULL)
+        {
+            framePrintf("-> ... %s more\n", formatCount(count, sizeof(count), list->length - shown));
+        }
+        else
+        {
+            framePrintf("-> NULL\n");
         }
-
-        printf(" → ");
-        i = (i + 1) % queue->capacity;
     }
 
-    printf(" ← REAR\n");
-
 #ifdef _WIN32
-    setColor(RESET);
+    frameColor(RESET);
 #else
-    setColor(RESET);
+    frameColor(RESET);
 #endif
 }
 
-void queueDemo()
+// Sorted set on a skip list, reached from the linked list menu
+void skipListDemo()
 {
-    clear();
-    printHeader();
-    printRetroBox("Queue Implementation",
-                  "This section demonstrates Queue operations\n"
-                  "with visual animations.");
-
-    loadingAnimation("Initializing Queue", 30);
-
-    int capacity = 10;
-    Queue *queue = createQueue(capacity);
-    int choice, value;
+    SkipList *skip = createSkipList();
+    int choice, value, high;
 
     do
     {
-        clear();
-        printRetroBox("Queue Operations",
-                      "1. Push Element\n"
-                      "2. Pop Element\n"
-                      "3. Animate Queue Operations\n"
-                      "0. Back to Main Menu");
+        beginFrame();
+        printRetroBox("Skip List Operations",
+                      "1. Insert Key\n"
+                      "2. Search Key\n"
+                      "3. Delete Key\n"
+                      "4. Range Scan\n"
+                      "0. Back to Linked List Menu");
 
-        visualizeQueue(queue);
+        visualizeSkipList(skip);
 
 #ifdef _WIN32
-        setColor(CYAN);
+        frameColor(CYAN);
 #else
-        setColor(CYAN);
+        frameColor(CYAN);
 #endif
 
-        printf("\n\tEnter operation choice: ");
+        framePrintf("\n\tEnter operation choice: ");
 
 #ifdef _WIN32
-        setColor(RESET);
+        frameColor(RESET);
 #else
-        setColor(RESET);
+        frameColor(RESET);
 #endif
+        frameFlush();
 
         if (scanf("%d", &choice) != 1)
         {
@@ -1020,134 +2571,51 @@ void queueDemo()
         switch (choice)
         {
         case 1:
-            if (isQueueFull(queue))
+        case 2:
+        case 3:
+        case 4:
+            printf(choice == 4 ? "\t\tEnter lower and upper bound: " : "\t\tEnter key: ");
+            if (scanf("%d", &value) != 1 || (choice == 4 && scanf("%d", &high) != 1))
             {
-#ifdef _WIN32
-                setColor(RED);
-#else
-                setColor(RED);
-#endif
-
-                printf("\t\tQueue is Full! Cannot enqueue more elements.\n");
+                while (getchar() != '\n')
+                    ;
+                printf("\t\tInvalid input!\n");
+                SLEEP(1000);
+                break;
+            }
 
 #ifdef _WIN32
-                setColor(RESET);
+            setColor(YELLOW);
 #else
-                setColor(RESET);
+            setColor(YELLOW);
 #endif
+
+            if (choice == 1)
+            {
+                printf("\t\tKey %d %s\n", value, skipInsert(skip, value) ? "inserted!" : "already in the set.");
             }
-            else
+            else if (choice == 2)
             {
-                printf("\t\tEnter value to enqueue: ");
-                if (scanf("%d", &value) != 1)
-                {
-                    while (getchar() != '\n')
-                        ;
-                    printf("\t\tInvalid input!\n");
-                    SLEEP(1000);
-                    break;
-                }
-                enqueue(queue, value);
-
-#ifdef _WIN32
-                setColor(GREEN);
-#else
-                setColor(GREEN);
-#endif
-
-                printf("\t\tValue %d added to queue!\n", value);
-
-#ifdef _WIN32
-                setColor(RESET);
-#else
-                setColor(RESET);
-#endif
+                printf("\t\tKey %d %s\n", value, skipSearch(skip, value) ? "found!" : "not found.");
             }
-            SLEEP(1000);
-            break;
-
-        case 2:
-            if (isQueueEmpty(queue))
+            else if (choice == 3)
             {
-#ifdef _WIN32
-                setColor(RED);
-#else
-                setColor(RED);
-#endif
-
-                printf("\t\tQueue is Empty! Nothing to dequeue.\n");
-
-#ifdef _WIN32
-                setColor(RESET);
-#else
-                setColor(RESET);
-#endif
+                printf("\t\tKey %d %s\n", value, skipDelete(skip, value) ? "deleted!" : "not found.");
             }
             else
             {
-                value = dequeue(queue);
-
-#ifdef _WIN32
-                setColor(MAGENTA);
-#else
-                setColor(MAGENTA);
-#endif
-
-                printf("\t\tValue %d removed from queue!\n", value);
+                printf("\t\tKeys in [%d, %d]: ", value, high);
+                skipRangeScan(skip, value, high, printKeyAnimated, NULL);
+                printf("\n");
+            }
 
 #ifdef _WIN32
-                setColor(RESET);
+            setColor(RESET);
 #else
-                setColor(RESET);
+            setColor(RESET);
 #endif
-            }
-            SLEEP(1000);
-            break;
-
-        case 3:
-            printf("\n\t\tAnimating queue operations...\n");
-
-            // Clear any existing queue
-            while (!isQueueEmpty(queue))
-            {
-                dequeue(queue);
-            }
-
-            // Animate enqueuing
-            for (int i = 1; i <= 5; i++)
-            {
-                if (!isQueueFull(queue))
-                {
-                    enqueue(queue, i * 10);
-                    printf("\t\tEnqueuing %d...\n", i * 10);
-                    visualizeQueue(queue);
-                    SLEEP(1000);
-                    if (i < 5)
-                    {
-                        clear();
-                        printHeader();
-                    }
-                }
-            }
-
-            // Animate dequeuing
-            for (int i = 0; i < 3; i++)
-            {
-                if (!isQueueEmpty(queue))
-                {
-                    int val = dequeue(queue);
-                    printf("\t\tDequeuing %d...\n", val);
-                    visualizeQueue(queue);
-                    SLEEP(500);
-                    if (i < 2)
-                    {
-                        clear();
-                        printHeader();
-                    }
-                }
-            }
 
-            printf("\n\t\tAnimation complete! Press any key...");
+            printf("\t\tPress any key...");
             getch_wrapper();
             break;
         case 0:
@@ -1158,165 +2626,238 @@ void queueDemo()
         }
     } while (choice != 0);
 
-    free(queue->array);
-    free(queue);
+    freeSkipList(skip);
 }
 
-// Binary Tree Functions---------------------------------------------------------------
-TreeNode *createTreeNode(int data)
+// Stack Functions
+Stack *createStack(int capacity)
 {
-    TreeNode *newNode = (TreeNode *)malloc(sizeof(TreeNode));
-    if (newNode == NULL)
+    Stack *stack = (Stack *)malloc(sizeof(Stack));
+    if (stack == NULL)
     {
         fprintf(stderr, "Memory allocation failed!\n");
         exit(EXIT_FAILURE);
     }
-    newNode->data = data;
-    newNode->left = newNode->right = NULL;
-    return newNode;
+    if (capacity < 1)
+    {
+        capacity = 1;
+    }
+    stack->capacity = capacity;
+    stack->minCapacity = capacity;
+    stack->autoShrink = 0;
+    stack->mapping = NULL;
+    stack->mappingLength = 0;
+    stack->top = -1;
+    stack->array = (int *)malloc(capacity * sizeof(int));
+    STAT_ALLOC(STAT_STACK, sizeof(Stack));
+    STAT_ALLOC(STAT_STACK, capacity * sizeof(int));
+    if (stack->array == NULL)
+    {
+        free(stack);
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    return stack;
 }
 
-TreeNode *insertTreeNode(TreeNode *root, int data)
+int isStackEmpty(Stack *stack)
 {
-    if (root == NULL)
+    return stack->top == -1;
+}
+
+int isStackFull(Stack *stack)
+{
+    return stack->top == stack->capacity - 1;
+}
+
+int stackSize(Stack *stack)
+{
+    return stack->top + 1;
+}
+
+void resizeStack(Stack *stack, int capacity)
+{
+    int *array;
+    if (stack->mapping != NULL)
     {
-        return createTreeNode(data);
+        // A mapped snapshot cannot be realloc'd: copy out, then unmap
+        array = (int *)malloc(capacity * sizeof(int));
+        if (array != NULL)
+        {
+            memcpy(array, stack->array, stackSize(stack) * sizeof(int));
+            unmapSnapshot(stack->mapping, stack->mappingLength);
+            stack->mapping = NULL;
+        }
     }
-
-    if (data < root->data)
+    else
     {
-        root->left = insertTreeNode(root->left, data);
+        array = (int *)realloc(stack->array, capacity * sizeof(int));
     }
-    else if (data > root->data)
+    STAT_ALLOC(STAT_STACK, capacity * sizeof(int));
+    if (array == NULL)
     {
-        root->right = insertTreeNode(root->right, data);
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
     }
-
-    return root;
+    stack->array = array;
+    stack->capacity = capacity;
 }
 
-void visualizeBinaryTree(TreeNode *root, int space)
+// Makes room for at least capacity elements in one step
+void stackReserve(Stack *stack, int capacity)
 {
-    if (root == NULL)
+    if (capacity > stack->capacity)
     {
-        return;
+        resizeStack(stack, capacity);
     }
+}
 
-    space += 5;
-
-    visualizeBinaryTree(root->right, space);
-
-    printf("\n");
-    for (int i = 5; i < space; i++)
+void push(Stack *stack, int item)
+{
+    TRACE_BEGIN();
+    if (isStackFull(stack))
     {
-        printf(" ");
+        STAT_ADD(stackFull, 1);
+        if (stack->capacity > INT_MAX / 2)
+        {
+            fprintf(stderr, "Stack capacity limit reached!\n");
+            exit(EXIT_FAILURE);
+        }
+        resizeStack(stack, stack->capacity * 2);
     }
-
-#ifdef _WIN32
-    setColor(GREEN);
-#else
-    setColor(GREEN);
-#endif
-
-    printf("[%d]", root->data);
-
-#ifdef _WIN32
-    setColor(RESET);
-#else
-    setColor(RESET);
-#endif
-
-    visualizeBinaryTree(root->left, space);
+    stack->array[++stack->top] = item;
+    TRACE_END("push");
 }
 
-void inorderTraversal(TreeNode *root)
+int pop(Stack *stack)
 {
-    if (root != NULL)
+    TRACE_BEGIN();
+    if (isStackEmpty(stack))
     {
-        inorderTraversal(root->left);
-        printf("%d ", root->data);
-        fflush(stdout); // Added for animation effect
-        SLEEP(100);     // Added for animation effect
-        inorderTraversal(root->right);
+        STAT_ADD(stackEmpty, 1);
+        TRACE_END("pop");
+        return -1;
     }
-}
 
-void preorderTraversal(TreeNode *root)
-{
-    if (root != NULL)
+    int item = stack->array[stack->top--];
+    if (stack->autoShrink && stackSize(stack) < stack->capacity / 4 &&
+        stack->capacity / 2 >= stack->minCapacity)
     {
-        printf("%d ", root->data);
-        fflush(stdout); // Added for animation effect
-        SLEEP(100);     // Added for animation effect
-        preorderTraversal(root->left);
-        preorderTraversal(root->right);
+        resizeStack(stack, stack->capacity / 2);
     }
+    TRACE_END("pop");
+    return item;
 }
 
-void postorderTraversal(TreeNode *root)
+void freeStack(Stack *stack)
 {
-    if (root != NULL)
+    if (stack->mapping != NULL)
+    {
+        unmapSnapshot(stack->mapping, stack->mappingLength);
+    }
+    else
     {
-        postorderTraversal(root->left);
-        postorderTraversal(root->right);
-        printf("%d ", root->data);
-        fflush(stdout); // Added for animation effect
-        SLEEP(100);     // Added for animation effect
+        free(stack->array);
     }
+    free(stack);
 }
 
-void freeTree(TreeNode *root)
+void visualizeStack(Stack *stack)
 {
-    if (root != NULL)
+    char count[32];
+    int size = stackSize(stack);
+    int rows = viewRows(16) / 2; // Every element takes two lines
+
+    if (stackViewOffset >= size)
     {
-        freeTree(root->left);
-        freeTree(root->right);
-        free(root);
+        stackViewOffset = size > 0 ? size - 1 : 0;
+    }
+
+    framePrintf("\n\tStack Visualization (Top to Bottom, %d of %d slots used):\n",
+                size, stack->capacity);
+    if (stackViewOffset > 0)
+    {
+        framePrintf("\t  ... %s above\n", formatCount(count, sizeof(count), stackViewOffset));
+    }
+    framePrintf("\t┌───────┐\n");
+
+    int i = stack->top - stackViewOffset;
+    for (; i >= 0 && rows > 0; i--, rows--)
+    {
+#ifdef _WIN32
+        frameColor(YELLOW);
+#else
+        frameColor(YELLOW);
+#endif
+
+        framePrintf("\t│ %5d │", stack->array[i]);
+
+        if (i == stack->top)
+        {
+            framePrintf("  ← TOP");
+        }
+
+        framePrintf("\n");
+
+#ifdef _WIN32
+        frameColor(RESET);
+#else
+        frameColor(RESET);
+#endif
+
+        framePrintf("\t├───────┤\n");
+    }
+
+    if (i >= 0)
+    {
+        framePrintf("\t│  ...  │  %s more\n", formatCount(count, sizeof(count), i + 1));
     }
+    framePrintf("\t└───────┘\n");
 }
 
-void binaryTreeDemo()
+void stackDemo()
 {
     clear();
     printHeader();
-    printRetroBox("Binary Tree Visualization",
-                  "This section demonstrates Binary Tree operations\n"
-                  "with visual animations and traversal demonstrations.");
+    printRetroBox("Stack Implementation",
+                  "This section demonstrates Stack operations\n"
+                  "with visual animations.");
 
-    loadingAnimation("Initializing Binary Tree", 30);
+    loadingAnimation("Initializing Stack", 30);
 
-    TreeNode *root = NULL;
+    int capacity = 10;
+    Stack *stack = createStack(capacity);
     int choice, value;
 
     do
     {
-        clear();
-        
-        printRetroBox("Binary Tree Operations",
-                      "1. Insert Node\n"
-                      "2. Inorder Traversal\n"
-                      "3. Preorder Traversal\n"
-                      "4. Postorder Traversal\n"
-                      "5. Animate Tree Traversal\n"
+        beginFrame();
+
+        printRetroBox("Stack Operations",
+                      "1. Push Element\n"
+                      "2. Pop Element\n"
+                      "3. Toggle Auto-Shrink\n"
+                      "4. Scroll View\n"
+                      "5. Save Snapshot\n"
+                      "6. Load Snapshot\n"
                       "0. Back to Main Menu");
 
-        printf("\n\tCurrent Binary Tree Structure:\n");
-        visualizeBinaryTree(root, 0);
-        printf("\n\n");
+        visualizeStack(stack);
 
 #ifdef _WIN32
-        setColor(CYAN);
+        frameColor(CYAN);
 #else
-        setColor(CYAN);
+        frameColor(CYAN);
 #endif
 
-        printf("\t\tEnter operation choice: ");
+        framePrintf("\n\t\tEnter operation choice: ");
 
 #ifdef _WIN32
-        setColor(RESET);
+        frameColor(RESET);
 #else
-        setColor(RESET);
+        frameColor(RESET);
 #endif
+        frameFlush();
 
         if (scanf("%d", &choice) != 1)
         {
@@ -1328,7 +2869,8 @@ void binaryTreeDemo()
         switch (choice)
         {
         case 1:
-            printf("\t\tEnter value to insert: ");
+            // The stack grows on demand, so a push can no longer overflow
+            printf("\t\tEnter value to push: ");
             if (scanf("%d", &value) != 1)
             {
                 while (getchar() != '\n')
@@ -1337,7 +2879,7 @@ void binaryTreeDemo()
                 SLEEP(1000);
                 break;
             }
-            root = insertTreeNode(root, value);
+            push(stack, value);
 
 #ifdef _WIN32
             setColor(GREEN);
@@ -1345,106 +2887,8697 @@ void binaryTreeDemo()
             setColor(GREEN);
 #endif
 
-            printf("\t\tNode with value %d inserted successfully!\n", value);
+            printf("\t\tValue %d pushed onto stack!\n", value);
 
 #ifdef _WIN32
             setColor(RESET);
 #else
             setColor(RESET);
 #endif
-
             SLEEP(1000);
             break;
 
         case 2:
-            printf("\n\t\tInorder Traversal: ");
-
+            if (isStackEmpty(stack))
+            {
 #ifdef _WIN32
-            setColor(YELLOW);
+                setColor(RED);
 #else
-            setColor(YELLOW);
+                setColor(RED);
 #endif
 
-            inorderTraversal(root);
+                printf("\t\tStack Underflow! Stack is empty.\n");
 
 #ifdef _WIN32
-            setColor(RESET);
+                setColor(RESET);
 #else
-            setColor(RESET);
+                setColor(RESET);
 #endif
-
-            printf("\n\t\tTraversal complete! Press any key...");
-            getch_wrapper();
-            break;
-
-        case 3:
-            printf("\n\t\tPreorder Traversal: ");
+            }
+            else
+            {
+                value = pop(stack);
 
 #ifdef _WIN32
-            setColor(YELLOW);
+                setColor(MAGENTA);
 #else
-            setColor(YELLOW);
+                setColor(MAGENTA);
 #endif
 
-            preorderTraversal(root);
+                printf("\t\tValue %d popped from stack!\n", value);
 
 #ifdef _WIN32
-            setColor(RESET);
+                setColor(RESET);
 #else
-            setColor(RESET);
+                setColor(RESET);
 #endif
-
-            printf("\n\t\tTraversal complete! Press any key...");
-            getch_wrapper();
+            }
+            SLEEP(1000);
             break;
 
+        case 3:
+            stack->autoShrink = !stack->autoShrink;
+            printf("\t\tAuto-shrink %s!\n", stack->autoShrink ? "enabled" : "disabled");
+            SLEEP(1000);
+            break;
         case 4:
-            printf("\n\t\tPostorder Traversal: ");
+        {
+            long long offset;
+            if (readViewOffset("\t\tElements to skip below the top (0 = top): ", &offset))
+            {
+                stackViewOffset = offset > INT_MAX ? INT_MAX : (int)offset;
+            }
+            break;
+        }
+        case 5:
+        case 6:
+        {
+            char path[256];
+            if (!readFilePath("\t\tSnapshot file: ", path))
+            {
+                break;
+            }
+            if (choice == 5)
+            {
+                reportSnapshot(saveStackSnapshot(stack, path), 1, path);
+                break;
+            }
+            Stack *loaded = loadStackSnapshot(path);
+            if (loaded != NULL)
+            {
+                freeStack(stack);
+                stack = loaded;
+            }
+            reportSnapshot(loaded != NULL, 0, path);
+            break;
+        }
+        case 0:
+            break; // Exit loop
+        default:
+            printf("\t\tInvalid choice!\n");
+            SLEEP(1000);
+        }
+    } while (choice != 0);
+
+    freeStack(stack);
+    stackViewOffset = 0;
+}
+
+// Queue Functions
+Queue *createQueue(int capacity)
+{
+    Queue *queue = (Queue *)malloc(sizeof(Queue));
+    if (queue == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    if (capacity < 1)
+    {
+        capacity = 1;
+    }
+    queue->capacity = capacity;
+    queue->minCapacity = capacity;
+    queue->autoShrink = 0;
+    queue->mapping = NULL;
+    queue->mappingLength = 0;
+    queue->front = queue->rear = -1;
+    queue->array = (int *)malloc(capacity * sizeof(int));
+    STAT_ALLOC(STAT_QUEUE, sizeof(Queue));
+    STAT_ALLOC(STAT_QUEUE, capacity * sizeof(int));
+    if (queue->array == NULL)
+    {
+        free(queue);
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    return queue;
+}
+
+int isQueueEmpty(Queue *queue)
+{
+    return queue->front == -1;
+}
+
+int isQueueFull(Queue *queue)
+{
+    return (queue->rear + 1) % queue->capacity == queue->front;
+}
+
+int queueSize(Queue *queue)
+{
+    if (isQueueEmpty(queue))
+    {
+        return 0;
+    }
+    return (queue->rear - queue->front + queue->capacity) % queue->capacity + 1;
+}
+
+// Moves the elements into a new array of the given capacity, unwrapping the
+// ring so the front lands at index 0
+void resizeQueue(Queue *queue, int capacity)
+{
+    int size = queueSize(queue);
+    int *array = (int *)malloc(capacity * sizeof(int));
+    if (array == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    STAT_ALLOC(STAT_QUEUE, capacity * sizeof(int));
+
+    if (size > 0)
+    {
+        int firstPart = queue->capacity - queue->front;
+        if (firstPart > size)
+        {
+            firstPart = size;
+        }
+        memcpy(array, &queue->array[queue->front], firstPart * sizeof(int));
+        memcpy(&array[firstPart], queue->array, (size - firstPart) * sizeof(int));
+        queue->front = 0;
+        queue->rear = size - 1;
+    }
+
+    if (queue->mapping != NULL)
+    {
+        unmapSnapshot(queue->mapping, queue->mappingLength);
+        queue->mapping = NULL;
+    }
+    else
+    {
+        free(queue->array);
+    }
+    queue->array = array;
+    queue->capacity = capacity;
+}
+
+// Makes room for at least capacity elements in one step
+void queueReserve(Queue *queue, int capacity)
+{
+    if (capacity > queue->capacity)
+    {
+        resizeQueue(queue, capacity);
+    }
+}
+
+void enqueue(Queue *queue, int item)
+{
+    TRACE_BEGIN();
+    if (isQueueFull(queue))
+    {
+        STAT_ADD(queueFull, 1);
+        if (queue->capacity > INT_MAX / 2)
+        {
+            fprintf(stderr, "Queue capacity limit reached!\n");
+            exit(EXIT_FAILURE);
+        }
+        resizeQueue(queue, queue->capacity * 2);
+    }
+
+    if (isQueueEmpty(queue))
+    {
+        queue->front = queue->rear = 0;
+    }
+    else
+    {
+        queue->rear = (queue->rear + 1) % queue->capacity;
+    }
+
+    queue->array[queue->rear] = item;
+    TRACE_END("enqueue");
+}
+
+int dequeue(Queue *queue)
+{
+    TRACE_BEGIN();
+    if (isQueueEmpty(queue))
+    {
+        STAT_ADD(queueEmpty, 1);
+        TRACE_END("dequeue");
+        return -1;
+    }
+
+    int item = queue->array[queue->front];
+
+    if (queue->front == queue->rear)
+    {
+        queue->front = queue->rear = -1;
+    }
+    else
+    {
+        queue->front = (queue->front + 1) % queue->capacity;
+    }
+
+    if (queue->autoShrink && queueSize(queue) < queue->capacity / 4 &&
+        queue->capacity / 2 >= queue->minCapacity)
+    {
+        resizeQueue(queue, queue->capacity / 2);
+    }
+
+    TRACE_END("dequeue");
+    return item;
+}
+
+void freeQueue(Queue *queue)
+{
+    if (queue->mapping != NULL)
+    {
+        unmapSnapshot(queue->mapping, queue->mappingLength);
+    }
+    else
+    {
+        free(queue->array);
+    }
+    free(queue);
+}
+
+void visualizeQueue(Queue *queue)
+{
+    char count[32];
+    int size = queueSize(queue);
+    int budget = viewColumns() - 20;
+
+    framePrintf("\n\tQueue Visualization (%d of %d slots used):\n", size, queue->capacity);
+    framePrintf("\t");
+
+    if (isQueueEmpty(queue))
+    {
+        framePrintf("[EMPTY QUEUE]\n");
+        return;
+    }
 
 #ifdef _WIN32
-            setColor(YELLOW);
+    frameColor(YELLOW);
 #else
-            setColor(YELLOW);
+    frameColor(YELLOW);
 #endif
 
-            postorderTraversal(root);
+    if (queueViewOffset >= size)
+    {
+        queueViewOffset = size - 1;
+    }
+    if (queueViewOffset > 0)
+    {
+        framePrintf("FRONT → ... %s → ", formatCount(count, sizeof(count), queueViewOffset));
+        budget -= 20;
+    }
+    else
+    {
+        framePrintf("FRONT → ");
+    }
+
+    // The ring is indexable, so only the visible window is touched
+    char item[24];
+    int shown = queueViewOffset;
+    while (shown < size)
+    {
+        int width = snprintf(item, sizeof(item), shown + 1 < size ? "[%d] → " : "[%d]",
+                             queue->array[(queue->front + shown) % queue->capacity]);
+        if (width > budget - 20)
+        {
+            break;
+        }
+        framePrintf("%s", item);
+        budget -= width;
+        shown++;
+    }
+
+    if (shown < size)
+    {
+        framePrintf("... %s more", formatCount(count, sizeof(count), size - shown));
+    }
+    framePrintf(" ← REAR\n");
 
 #ifdef _WIN32
-            setColor(RESET);
+    frameColor(RESET);
 #else
-            setColor(RESET);
+    frameColor(RESET);
 #endif
+}
 
-            printf("\n\t\tTraversal complete! Press any key...");
-            getch_wrapper();
-            break;
+void queueDemo()
+{
+    clear();
+    printHeader();
+    printRetroBox("Queue Implementation",
+                  "This section demonstrates Queue operations\n"
+                  "with visual animations.");
 
-        case 5:
-            printf("\n\t\tAnimating tree traversal...\n");
+    loadingAnimation("Initializing Queue", 30);
 
-            printf("\t\tInorder (L Root R): ");
-            inorderTraversal(root);
-            printf("\n");
+    int capacity = 10;
+    Queue *queue = createQueue(capacity);
+    int choice, value;
 
-            printf("\t\tPreorder (Root L R): ");
-            preorderTraversal(root);
-            printf("\n");
+    do
+    {
+        beginFrame();
+        printRetroBox("Queue Operations",
+                      "1. Push Element\n"
+                      "2. Pop Element\n"
+                      "3. Animate Queue Operations\n"
+                      "4. Toggle Auto-Shrink\n"
+                      "5. Scroll View\n"
+                      "6. Save Snapshot\n"
+                      "7. Load Snapshot\n"
+                      "8. Priority Queue (4-ary Heap)\n"
+                      "0. Back to Main Menu");
 
-            printf("\t\tPostorder (L R Root): ");
-            postorderTraversal(root);
-            printf("\n");
+        visualizeQueue(queue);
 
-            printf("\n\n\t\tAnimation complete! Press any key...");
-            getch_wrapper();
-            break;
-        case 0:
-            break; // Exit loop
-        default:
-            printf("\t\tInvalid choice!\n");
-            SLEEP(2000);
-        }
-    } while (choice != 0);
+#ifdef _WIN32
+        frameColor(CYAN);
+#else
+        frameColor(CYAN);
+#endif
+
+        framePrintf("\n\tEnter operation choice: ");
+
+#ifdef _WIN32
+        frameColor(RESET);
+#else
+        frameColor(RESET);
+#endif
+        frameFlush();
 
-    // Free tree memory
-    freeTree(root);
+        if (scanf("%d", &choice) != 1)
+        {
+            while (getchar() != '\n')
+                ;
+            choice = -1;
+        }
+
+        switch (choice)
+        {
+        case 1:
+            // The ring grows on demand, so an enqueue can no longer be dropped
+            printf("\t\tEnter value to enqueue: ");
+            if (scanf("%d", &value) != 1)
+            {
+                while (getchar() != '\n')
+                    ;
+                printf("\t\tInvalid input!\n");
+                SLEEP(1000);
+                break;
+            }
+            enqueue(queue, value);
+
+#ifdef _WIN32
+            setColor(GREEN);
+#else
+            setColor(GREEN);
+#endif
+
+            printf("\t\tValue %d added to queue!\n", value);
+
+#ifdef _WIN32
+            setColor(RESET);
+#else
+            setColor(RESET);
+#endif
+            SLEEP(1000);
+            break;
+
+        case 2:
+            if (isQueueEmpty(queue))
+            {
+#ifdef _WIN32
+                setColor(RED);
+#else
+                setColor(RED);
+#endif
+
+                printf("\t\tQueue is Empty! Nothing to dequeue.\n");
+
+#ifdef _WIN32
+                setColor(RESET);
+#else
+                setColor(RESET);
+#endif
+            }
+            else
+            {
+                value = dequeue(queue);
+
+#ifdef _WIN32
+                setColor(MAGENTA);
+#else
+                setColor(MAGENTA);
+#endif
+
+                printf("\t\tValue %d removed from queue!\n", value);
+
+#ifdef _WIN32
+                setColor(RESET);
+#else
+                setColor(RESET);
+#endif
+            }
+            SLEEP(1000);
+            break;
+
+        case 3:
+            printf("\n\t\tAnimating queue operations...\n");
+
+            // Clear any existing queue
+            while (!isQueueEmpty(queue))
+            {
+                dequeue(queue);
+            }
+
+            // Animate enqueuing
+            for (int i = 1; i <= 5; i++)
+            {
+                enqueue(queue, i * 10);
+                printf("\t\tEnqueuing %d...\n", i * 10);
+                visualizeQueue(queue);
+                SLEEP(1000);
+                if (i < 5)
+                {
+                    clear();
+                    printHeader();
+                }
+            }
+
+            // Animate dequeuing
+            for (int i = 0; i < 3; i++)
+            {
+                if (!isQueueEmpty(queue))
+                {
+                    int val = dequeue(queue);
+                    printf("\t\tDequeuing %d...\n", val);
+                    visualizeQueue(queue);
+                    SLEEP(500);
+                    if (i < 2)
+                    {
+                        clear();
+                        printHeader();
+                    }
+                }
+            }
+
+            printf("\n\t\tAnimation complete! Press any key...");
+            getch_wrapper();
+            break;
+
+        case 4:
+            queue->autoShrink = !queue->autoShrink;
+            printf("\t\tAuto-shrink %s!\n", queue->autoShrink ? "enabled" : "disabled");
+            SLEEP(1000);
+            break;
+        case 5:
+        {
+            long long offset;
+            if (readViewOffset("\t\tElements to skip after the front (0 = front): ", &offset))
+            {
+                queueViewOffset = offset > INT_MAX ? INT_MAX : (int)offset;
+            }
+            break;
+        }
+        case 6:
+        case 7:
+        {
+            char path[256];
+            if (!readFilePath("\t\tSnapshot file: ", path))
+            {
+                break;
+            }
+            if (choice == 6)
+            {
+                reportSnapshot(saveQueueSnapshot(queue, path), 1, path);
+                break;
+            }
+            Queue *loaded = loadQueueSnapshot(path);
+            if (loaded != NULL)
+            {
+                freeQueue(queue);
+                queue = loaded;
+            }
+            reportSnapshot(loaded != NULL, 0, path);
+            break;
+        }
+        case 8:
+            priorityQueueDemo();
+            break;
+        case 0:
+            break; // Exit loop
+        default:
+            printf("\t\tInvalid choice!\n");
+            SLEEP(1000);
+        }
+    } while (choice != 0);
+
+    freeQueue(queue);
+    queueViewOffset = 0;
+}
+
+// Priority Queue Functions-------------------------------------------------------------
+
+PriorityQueue *createPriorityQueue(int capacity)
+{
+    PriorityQueue *heap = (PriorityQueue *)malloc(sizeof(PriorityQueue));
+    if (heap == NULL || capacity < 1)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    int idCapacity = capacity <= HEAP_MAX_ID ? capacity : HEAP_MAX_ID + 1;
+    heap->entries = (HeapEntry *)malloc(capacity * sizeof(HeapEntry));
+    heap->position = (int *)malloc(idCapacity * sizeof(int));
+    if (heap->entries == NULL || heap->position == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < idCapacity; i++)
+    {
+        heap->position[i] = -1;
+    }
+    heap->count = 0;
+    heap->capacity = capacity;
+    heap->idCapacity = idCapacity;
+    return heap;
+}
+
+void freePriorityQueue(PriorityQueue *heap)
+{
+    free(heap->entries);
+    free(heap->position);
+    free(heap);
+}
+
+// Grows the position index so it covers id (at most HEAP_MAX_ID)
+void heapReserveId(PriorityQueue *heap, int id)
+{
+    if (id < heap->idCapacity)
+    {
+        return;
+    }
+    int idCapacity = heap->idCapacity <= HEAP_MAX_ID / 2 ? 2 * heap->idCapacity : HEAP_MAX_ID + 1;
+    if (idCapacity <= id)
+    {
+        idCapacity = id + 1;
+    }
+    int *position = (int *)realloc(heap->position, (size_t)idCapacity * sizeof(int));
+    if (position == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = heap->idCapacity; i < idCapacity; i++)
+    {
+        position[i] = -1;
+    }
+    heap->position = position;
+    heap->idCapacity = idCapacity;
+}
+
+// Both sifts move a hole instead of swapping, writing the entry once at the end
+void heapSiftUp(PriorityQueue *heap, int slot)
+{
+    HeapEntry entry = heap->entries[slot];
+    while (slot > 0)
+    {
+        int parent = (slot - 1) / HEAP_ARITY;
+        if (heap->entries[parent].key <= entry.key)
+        {
+            break;
+        }
+        heap->entries[slot] = heap->entries[parent];
+        heap->position[heap->entries[slot].id] = slot;
+        slot = parent;
+    }
+    heap->entries[slot] = entry;
+    heap->position[entry.id] = slot;
+}
+
+void heapSiftDown(PriorityQueue *heap, int slot)
+{
+    HeapEntry entry = heap->entries[slot];
+    while (HEAP_ARITY * slot + 1 < heap->count)
+    {
+        int first = HEAP_ARITY * slot + 1;
+        int last = heap->count - first > HEAP_ARITY ? first + HEAP_ARITY : heap->count;
+        int smallest = first;
+        for (int child = first + 1; child < last; child++)
+        {
+            if (heap->entries[child].key < heap->entries[smallest].key)
+            {
+                smallest = child;
+            }
+        }
+        if (heap->entries[smallest].key >= entry.key)
+        {
+            break;
+        }
+        heap->entries[slot] = heap->entries[smallest];
+        heap->position[heap->entries[slot].id] = slot;
+        slot = smallest;
+    }
+    heap->entries[slot] = entry;
+    heap->position[entry.id] = slot;
+}
+
+// Returns 0 for an id outside 0..HEAP_MAX_ID or one already queued (use
+// heapDecreaseKey)
+int heapPush(PriorityQueue *heap, int id, int key)
+{
+    if (id < 0 || id > HEAP_MAX_ID)
+    {
+        return 0;
+    }
+    heapReserveId(heap, id);
+    if (heap->position[id] != -1)
+    {
+        return 0;
+    }
+    if (heap->count == heap->capacity)
+    {
+        HeapEntry *entries = (HeapEntry *)realloc(heap->entries, 2 * (size_t)heap->capacity * sizeof(HeapEntry));
+        if (entries == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+        heap->entries = entries;
+        heap->capacity *= 2;
+    }
+    heap->entries[heap->count].id = id;
+    heap->entries[heap->count].key = key;
+    heapSiftUp(heap, heap->count++);
+    return 1;
+}
+
+// Removes the entry with the smallest key; returns 0 when empty
+int heapPopMin(PriorityQueue *heap, int *id, int *key)
+{
+    if (heap->count == 0)
+    {
+        return 0;
+    }
+    *id = heap->entries[0].id;
+    *key = heap->entries[0].key;
+    heap->position[*id] = -1;
+    if (--heap->count > 0)
+    {
+        heap->entries[0] = heap->entries[heap->count];
+        heapSiftDown(heap, 0);
+    }
+    return 1;
+}
+
+// Lowers the key of a queued id in O(log n), found through the position index.
+// Returns 0 if the id is not queued or key is larger than its current one
+int heapDecreaseKey(PriorityQueue *heap, int id, int key)
+{
+    if (id < 0 || id >= heap->idCapacity || heap->position[id] == -1)
+    {
+        return 0;
+    }
+    int slot = heap->position[id];
+    if (key > heap->entries[slot].key)
+    {
+        return 0;
+    }
+    heap->entries[slot].key = key;
+    heapSiftUp(heap, slot);
+    return 1;
+}
+
+// Replaces the contents with count (id, key) pairs in O(n): the entries are
+// copied in as they are, then every parent is sifted down, deepest first.
+// Ids outside 0..HEAP_MAX_ID and repeated ids are skipped; returns the
+// number loaded
+int heapify(PriorityQueue *heap, const int *ids, const int *keys, int count)
+{
+    for (int i = 0; i < heap->count; i++)
+    {
+        heap->position[heap->entries[i].id] = -1;
+    }
+    heap->count = 0;
+    if (count > heap->capacity)
+    {
+        HeapEntry *entries = (HeapEntry *)realloc(heap->entries, (size_t)count * sizeof(HeapEntry));
+        if (entries == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+        heap->entries = entries;
+        heap->capacity = count;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (ids[i] < 0 || ids[i] > HEAP_MAX_ID)
+        {
+            continue;
+        }
+        heapReserveId(heap, ids[i]);
+        if (heap->position[ids[i]] != -1)
+        {
+            continue;
+        }
+        heap->entries[heap->count].id = ids[i];
+        heap->entries[heap->count].key = keys[i];
+        heap->position[ids[i]] = heap->count++;
+    }
+
+    for (int slot = (heap->count - 2) / HEAP_ARITY; slot >= 0 && heap->count > 1; slot--)
+    {
+        heapSiftDown(heap, slot);
+    }
+    return heap->count;
+}
+
+// Copies the k smallest entries to out in key order without removing them.
+// A candidate set seeded with the root and refilled with each taken entry's
+// children touches O(k) slots, so this costs O(k log k) however large the heap
+int heapTopK(PriorityQueue *heap, int k, HeapEntry *out)
+{
+    if (k > heap->count)
+    {
+        k = heap->count;
+    }
+    if (k <= 0)
+    {
+        return 0;
+    }
+
+    // Each step takes one candidate and adds at most HEAP_ARITY
+    int *candidates = (int *)malloc(((size_t)(HEAP_ARITY - 1) * k + 1) * sizeof(int));
+    if (candidates == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    const HeapEntry *entries = heap->entries;
+    int size = 1;
+    candidates[0] = 0;
+
+    for (int found = 0; found < k; found++)
+    {
+        // Candidates form a binary min-heap of slots, ordered by their keys
+        int slot = candidates[0];
+        out[found] = entries[slot];
+
+        int last = candidates[--size];
+        int hole = 0;
+        while (2 * hole + 1 < size)
+        {
+            int child = 2 * hole + 1;
+            if (child + 1 < size && entries[candidates[child + 1]].key < entries[candidates[child]].key)
+            {
+                child++;
+            }
+            if (entries[candidates[child]].key >= entries[last].key)
+            {
+                break;
+            }
+            candidates[hole] = candidates[child];
+            hole = child;
+        }
+        if (size > 0)
+        {
+            candidates[hole] = last;
+        }
+
+        int first = HEAP_ARITY * slot + 1;
+        for (int child = first; child < first + HEAP_ARITY && child < heap->count; child++)
+        {
+            hole = size++;
+            while (hole > 0 && entries[candidates[(hole - 1) / 2]].key > entries[child].key)
+            {
+                candidates[hole] = candidates[(hole - 1) / 2];
+                hole = (hole - 1) / 2;
+            }
+            candidates[hole] = child;
+        }
+    }
+
+    free(candidates);
+    return k;
+}
+
+// Draws the heap level by level as [key:#id], up to what fits on screen
+void visualizePriorityQueue(PriorityQueue *heap)
+{
+    char count[32], item[32];
+    int budget = viewColumns() - 30;
+
+    framePrintf("\n\tPriority Queue Visualization (4-ary min-heap, %s entries):\n",
+                formatCount(count, sizeof(count), heap->count));
+
+    if (heap->count == 0)
+    {
+        framePrintf("\t[EMPTY PRIORITY QUEUE]\n");
+        return;
+    }
+
+#ifdef _WIN32
+    frameColor(YELLOW);
+#else
+    frameColor(YELLOW);
+#endif
+
+    long long first = 0, width = 1;
+    for (int level = 1; first < heap->count && level <= 6; level++)
+    {
+        long long end = first + width < heap->count ? first + width : heap->count;
+        long long slot = first;
+        int used = 0;
+
+        framePrintf("\tL%-2d", level);
+        for (; slot < end; slot++)
+        {
+            int length = snprintf(item, sizeof(item), " [%d:#%d]", heap->entries[slot].key, heap->entries[slot].id);
+            if (used + length > budget)
+            {
+                break;
+            }
+            framePrintf("%s", item);
+            used += length;
+        }
+        if (slot < end)
+        {
+            framePrintf(" ... %s more", formatCount(count, sizeof(count), end - slot));
+        }
+        framePrintf("\n");
+
+        first = end;
+        width *= HEAP_ARITY;
+    }
+    if (first < heap->count)
+    {
+        framePrintf("\t... %s entries on deeper levels\n", formatCount(count, sizeof(count), heap->count - first));
+    }
+
+#ifdef _WIN32
+    frameColor(RESET);
+#else
+    frameColor(RESET);
+#endif
+}
+
+// Scheduler-style priority queue, reached from the queue menu
+void priorityQueueDemo()
+{
+    PriorityQueue *heap = createPriorityQueue(16);
+    int choice, id, key;
+
+    do
+    {
+        beginFrame();
+        printRetroBox("Priority Queue Operations",
+                      "1. Push (id, priority)\n"
+                      "2. Pop Minimum\n"
+                      "3. Decrease Key\n"
+                      "4. Show Top K\n"
+                      "5. Heapify Random Entries\n"
+                      "0. Back to Queue Menu");
+
+        visualizePriorityQueue(heap);
+
+#ifdef _WIN32
+        frameColor(CYAN);
+#else
+        frameColor(CYAN);
+#endif
+
+        framePrintf("\n\tEnter operation choice: ");
+
+#ifdef _WIN32
+        frameColor(RESET);
+#else
+        frameColor(RESET);
+#endif
+        frameFlush();
+
+        if (scanf("%d", &choice) != 1)
+        {
+            while (getchar() != '\n')
+                ;
+            choice = -1;
+        }
+
+        switch (choice)
+        {
+        case 1:
+        case 3:
+            printf(choice == 1 ? "\t\tEnter id and priority: " : "\t\tEnter id and new (lower) priority: ");
+            if (scanf("%d %d", &id, &key) != 2)
+            {
+                while (getchar() != '\n')
+                    ;
+                printf("\t\tInvalid input!\n");
+                SLEEP(1000);
+                break;
+            }
+
+#ifdef _WIN32
+            setColor(YELLOW);
+#else
+            setColor(YELLOW);
+#endif
+
+            if (choice == 1)
+            {
+                printf("\t\tId %d %s\n", id, heapPush(heap, id, key) ? "queued!" : "is out of range or already queued.");
+            }
+            else
+            {
+                printf("\t\tId %d %s\n", id,
+                       heapDecreaseKey(heap, id, key) ? "moved up!" : "is not queued or has a lower priority.");
+            }
+
+#ifdef _WIN32
+            setColor(RESET);
+#else
+            setColor(RESET);
+#endif
+            SLEEP(1000);
+            break;
+
+        case 2:
+            if (heapPopMin(heap, &id, &key))
+            {
+#ifdef _WIN32
+                setColor(MAGENTA);
+#else
+                setColor(MAGENTA);
+#endif
+
+                printf("\t\tId %d (priority %d) removed!\n", id, key);
+
+#ifdef _WIN32
+                setColor(RESET);
+#else
+                setColor(RESET);
+#endif
+            }
+            else
+            {
+#ifdef _WIN32
+                setColor(RED);
+#else
+                setColor(RED);
+#endif
+
+                printf("\t\tPriority queue is empty!\n");
+
+#ifdef _WIN32
+                setColor(RESET);
+#else
+                setColor(RESET);
+#endif
+            }
+            SLEEP(1000);
+            break;
+
+        case 4:
+        {
+            int k;
+            printf("\t\tHow many entries? ");
+            if (scanf("%d", &k) != 1 || k < 1)
+            {
+                while (getchar() != '\n')
+                    ;
+                printf("\t\tInvalid input!\n");
+                SLEEP(1000);
+                break;
+            }
+            HeapEntry *top = (HeapEntry *)malloc((size_t)(k < heap->count ? k : heap->count + 1) * sizeof(HeapEntry));
+            if (top == NULL)
+            {
+                fprintf(stderr, "Memory allocation failed!\n");
+                exit(EXIT_FAILURE);
+            }
+            int found = heapTopK(heap, k, top);
+            printf("\t\tTop %d:", found);
+            for (int i = 0; i < found; i++)
+            {
+                printf(" [%d:#%d]", top[i].key, top[i].id);
+            }
+            printf("\n\t\tPress any key...");
+            free(top);
+            getch_wrapper();
+            break;
+        }
+
+        case 5:
+        {
+            int count;
+            printf("\t\tHow many entries (ids 0..n-1, random priorities)? ");
+            if (scanf("%d", &count) != 1 || count < 1)
+            {
+                while (getchar() != '\n')
+                    ;
+                printf("\t\tInvalid input!\n");
+                SLEEP(1000);
+                break;
+            }
+            unsigned long long seed = (unsigned long long)time(NULL) | 1;
+            int *ids = (int *)malloc((size_t)count * sizeof(int));
+            int *keys = (int *)malloc((size_t)count * sizeof(int));
+            if (ids == NULL || keys == NULL)
+            {
+                fprintf(stderr, "Memory allocation failed!\n");
+                exit(EXIT_FAILURE);
+            }
+            for (int i = 0; i < count; i++)
+            {
+                ids[i] = i;
+                keys[i] = (int)(nextRandom(&seed) % 1000);
+            }
+            heapify(heap, ids, keys, count);
+            free(ids);
+            free(keys);
+            break;
+        }
+
+        case 0:
+            break; // Exit loop
+        default:
+            printf("\t\tInvalid choice!\n");
+            SLEEP(1000);
+        }
+    } while (choice != 0);
+
+    freePriorityQueue(heap);
+}
+
+// Generic Structure Functions----------------------------------------------------------
+
+// The structures above hold int. The DEFINE_* macros below stamp out the same
+// structures for any element type T: each takes the struct name, the function
+// prefix and T, and the ordered ones a COMPARE(a, b) macro returning <0, 0 or
+// >0. COMPARE is pasted into the generated code rather than passed as a
+// function pointer, so every comparison on the hot path is inlined
+#define KEY_STRING_SIZE 16
+
+// Fixed-width string key. makeKeyString zero-pads it, which makes memcmp
+// order keys like strcmp; longer text is cut at KEY_STRING_SIZE bytes
+typedef struct
+{
+    char bytes[KEY_STRING_SIZE];
+} KeyString;
+
+// 64-bit ID with a payload, ordered and matched on key alone: probe with
+// {key, 0} and the stored payload comes back from find
+typedef struct
+{
+    int64_t key;
+    int64_t payload;
+} KeyPayload;
+
+// NaN is unordered, so keep it out of double keys
+#define COMPARE_NUMBER(a, b) (((a) > (b)) - ((a) < (b)))
+#define COMPARE_KEY_STRING(a, b) memcmp((a).bytes, (b).bytes, KEY_STRING_SIZE)
+#define COMPARE_KEY_PAYLOAD(a, b) COMPARE_NUMBER((a).key, (b).key)
+
+KeyString makeKeyString(const char *text)
+{
+    KeyString key;
+    size_t length = strlen(text);
+
+    memset(&key, 0, sizeof(key));
+    memcpy(key.bytes, text, length < KEY_STRING_SIZE ? length : KEY_STRING_SIZE);
+    return key;
+}
+
+// Singly linked list with a tail pointer, nodes from its own pool like Node.
+// Delete unlinks the first element comparing equal; freeAll releases the
+// nodes of every list of this type, like freeAllListNodes
+#define DEFINE_LIST(Type, prefix, T, COMPARE)                                                 \
+    typedef struct Type##Node                                                                 \
+    {                                                                                         \
+        T data;                                                                               \
+        struct Type##Node *next;                                                              \
+    } Type##Node;                                                                             \
+                                                                                              \
+    typedef struct                                                                            \
+    {                                                                                         \
+        Type##Node *head;                                                                     \
+        Type##Node *tail;                                                                     \
+        long long length;                                                                     \
+    } Type;                                                                                   \
+                                                                                              \
+    NodePool prefix##Pool = POOL_INIT(Type##Node);                                            \
+                                                                                              \
+    void prefix##Insert(Type *list, T data)                                                   \
+    {                                                                                         \
+        Type##Node *node = (Type##Node *)poolAlloc(&prefix##Pool);                            \
+        node->data = data;                                                                    \
+        node->next = NULL;                                                                    \
+        if (list->tail != NULL)                                                               \
+        {                                                                                     \
+            list->tail->next = node;                                                          \
+        }                                                                                     \
+        else                                                                                  \
+        {                                                                                     \
+            list->head = node;                                                                \
+        }                                                                                     \
+        list->tail = node;                                                                    \
+        list->length++;                                                                       \
+    }                                                                                         \
+                                                                                              \
+    T *prefix##Find(Type *list, T probe)                                                      \
+    {                                                                                         \
+        for (Type##Node *node = list->head; node != NULL; node = node->next)                  \
+        {                                                                                     \
+            if (COMPARE(node->data, probe) == 0)                                              \
+            {                                                                                 \
+                return &node->data;                                                           \
+            }                                                                                 \
+        }                                                                                     \
+        return NULL;                                                                          \
+    }                                                                                         \
+                                                                                              \
+    int prefix##Delete(Type *list, T probe)                                                   \
+    {                                                                                         \
+        Type##Node *previous = NULL;                                                          \
+        for (Type##Node *node = list->head; node != NULL; previous = node, node = node->next) \
+        {                                                                                     \
+            if (COMPARE(node->data, probe) == 0)                                              \
+            {                                                                                 \
+                if (previous != NULL)                                                         \
+                {                                                                             \
+                    previous->next = node->next;                                              \
+                }                                                                             \
+                else                                                                          \
+                {                                                                             \
+                    list->head = node->next;                                                  \
+                }                                                                             \
+                if (list->tail == node)                                                       \
+                {                                                                             \
+                    list->tail = previous;                                                    \
+                }                                                                             \
+                poolFree(&prefix##Pool, node);                                                \
+                list->length--;                                                               \
+                return 1;                                                                     \
+            }                                                                                 \
+        }                                                                                     \
+        return 0;                                                                             \
+    }                                                                                         \
+                                                                                              \
+    void prefix##FreeAll(void)                                                                \
+    {                                                                                         \
+        poolDestroy(&prefix##Pool);                                                           \
+    }
+
+// Growable array stack. Pop returns 0 when empty, since no T value is free
+// to act as the -1 the int Stack uses
+#define DEFINE_STACK(Type, prefix, T)                                                       \
+    typedef struct                                                                          \
+    {                                                                                       \
+        T *array;                                                                           \
+        int top;                                                                            \
+        int capacity;                                                                       \
+    } Type;                                                                                 \
+                                                                                            \
+    Type *create##Type(int capacity)                                                        \
+    {                                                                                       \
+        Type *stack = (Type *)malloc(sizeof(Type));                                         \
+        if (stack == NULL || capacity < 1)                                                  \
+        {                                                                                   \
+            fprintf(stderr, "Memory allocation failed!\n");                                 \
+            exit(EXIT_FAILURE);                                                             \
+        }                                                                                   \
+        stack->array = (T *)malloc(capacity * sizeof(T));                                   \
+        if (stack->array == NULL)                                                           \
+        {                                                                                   \
+            fprintf(stderr, "Memory allocation failed!\n");                                 \
+            exit(EXIT_FAILURE);                                                             \
+        }                                                                                   \
+        stack->top = -1;                                                                    \
+        stack->capacity = capacity;                                                         \
+        return stack;                                                                       \
+    }                                                                                       \
+                                                                                            \
+    void prefix##Push(Type *stack, T item)                                                  \
+    {                                                                                       \
+        if (stack->top == stack->capacity - 1)                                              \
+        {                                                                                   \
+            T *array = (T *)realloc(stack->array, 2 * (size_t)stack->capacity * sizeof(T)); \
+            if (array == NULL)                                                              \
+            {                                                                               \
+                fprintf(stderr, "Memory allocation failed!\n");                             \
+                exit(EXIT_FAILURE);                                                         \
+            }                                                                               \
+            stack->array = array;                                                           \
+            stack->capacity *= 2;                                                           \
+        }                                                                                   \
+        stack->array[++stack->top] = item;                                                  \
+    }                                                                                       \
+                                                                                            \
+    int prefix##Pop(Type *stack, T *item)                                                   \
+    {                                                                                       \
+        if (stack->top == -1)                                                               \
+        {                                                                                   \
+            return 0;                                                                       \
+        }                                                                                   \
+        *item = stack->array[stack->top--];                                                 \
+        return 1;                                                                           \
+    }                                                                                       \
+                                                                                            \
+    void free##Type(Type *stack)                                                            \
+    {                                                                                       \
+        free(stack->array);                                                                 \
+        free(stack);                                                                        \
+    }
+
+// Growable circular queue; Dequeue returns 0 when empty
+#define DEFINE_QUEUE(Type, prefix, T)                                          \
+    typedef struct                                                             \
+    {                                                                          \
+        T *array;                                                              \
+        int front;                                                             \
+        int count;                                                             \
+        int capacity;                                                          \
+    } Type;                                                                    \
+                                                                               \
+    Type *create##Type(int capacity)                                           \
+    {                                                                          \
+        Type *queue = (Type *)malloc(sizeof(Type));                            \
+        if (queue == NULL || capacity < 1)                                     \
+        {                                                                      \
+            fprintf(stderr, "Memory allocation failed!\n");                    \
+            exit(EXIT_FAILURE);                                                \
+        }                                                                      \
+        queue->array = (T *)malloc(capacity * sizeof(T));                      \
+        if (queue->array == NULL)                                              \
+        {                                                                      \
+            fprintf(stderr, "Memory allocation failed!\n");                    \
+            exit(EXIT_FAILURE);                                                \
+        }                                                                      \
+        queue->front = 0;                                                      \
+        queue->count = 0;                                                      \
+        queue->capacity = capacity;                                            \
+        return queue;                                                          \
+    }                                                                          \
+                                                                               \
+    void prefix##Enqueue(Type *queue, T item)                                  \
+    {                                                                          \
+        if (queue->count == queue->capacity)                                   \
+        {                                                                      \
+            T *array = (T *)malloc(2 * (size_t)queue->capacity * sizeof(T));   \
+            if (array == NULL)                                                 \
+            {                                                                  \
+                fprintf(stderr, "Memory allocation failed!\n");                \
+                exit(EXIT_FAILURE);                                            \
+            }                                                                  \
+            for (int i = 0; i < queue->count; i++)                             \
+            {                                                                  \
+                array[i] = queue->array[(queue->front + i) % queue->capacity]; \
+            }                                                                  \
+            free(queue->array);                                                \
+            queue->array = array;                                              \
+            queue->front = 0;                                                  \
+            queue->capacity *= 2;                                              \
+        }                                                                      \
+        queue->array[(queue->front + queue->count) % queue->capacity] = item;  \
+        queue->count++;                                                        \
+    }                                                                          \
+                                                                               \
+    int prefix##Dequeue(Type *queue, T *item)                                  \
+    {                                                                          \
+        if (queue->count == 0)                                                 \
+        {                                                                      \
+            return 0;                                                          \
+        }                                                                      \
+        *item = queue->array[queue->front];                                    \
+        queue->front = (queue->front + 1) % queue->capacity;                   \
+        queue->count--;                                                        \
+        return 1;                                                              \
+    }                                                                          \
+                                                                               \
+    void free##Type(Type *queue)                                               \
+    {                                                                          \
+        free(queue->array);                                                    \
+        free(queue);                                                           \
+    }
+
+// AVL tree, so ID-ordered inserts cannot degrade it the way they do the plain
+// BST. Insert returns 1 for a new element and overwrites an equal one (the
+// payload update for KeyPayload); Find returns the stored element or NULL.
+// Nodes come from the type's pool, released together by freeAll
+#define DEFINE_TREE(Type, prefix, T, COMPARE)                                           \
+    typedef struct Type##Node                                                           \
+    {                                                                                   \
+        T data;                                                                         \
+        int height;                                                                     \
+        struct Type##Node *left;                                                        \
+        struct Type##Node *right;                                                       \
+    } Type##Node;                                                                       \
+                                                                                        \
+    typedef struct                                                                      \
+    {                                                                                   \
+        Type##Node *root;                                                               \
+        long long size;                                                                 \
+    } Type;                                                                             \
+                                                                                        \
+    NodePool prefix##Pool = POOL_INIT(Type##Node);                                      \
+                                                                                        \
+    int prefix##Height(Type##Node *node)                                                \
+    {                                                                                   \
+        return node != NULL ? node->height : 0;                                         \
+    }                                                                                   \
+                                                                                        \
+    void prefix##UpdateHeight(Type##Node *node)                                         \
+    {                                                                                   \
+        int left = prefix##Height(node->left);                                          \
+        int right = prefix##Height(node->right);                                        \
+        node->height = 1 + (left > right ? left : right);                               \
+    }                                                                                   \
+                                                                                        \
+    Type##Node *prefix##Rotate(Type##Node *node, int left)                              \
+    {                                                                                   \
+        Type##Node *pivot = left ? node->right : node->left;                            \
+        if (left)                                                                       \
+        {                                                                               \
+            node->right = pivot->left;                                                  \
+            pivot->left = node;                                                         \
+        }                                                                               \
+        else                                                                            \
+        {                                                                               \
+            node->left = pivot->right;                                                  \
+            pivot->right = node;                                                        \
+        }                                                                               \
+        prefix##UpdateHeight(node);                                                     \
+        prefix##UpdateHeight(pivot);                                                    \
+        return pivot;                                                                   \
+    }                                                                                   \
+                                                                                        \
+    Type##Node *prefix##Rebalance(Type##Node *node)                                     \
+    {                                                                                   \
+        int balance = prefix##Height(node->left) - prefix##Height(node->right);         \
+        prefix##UpdateHeight(node);                                                     \
+        if (balance > 1)                                                                \
+        {                                                                               \
+            if (prefix##Height(node->left->left) < prefix##Height(node->left->right))   \
+            {                                                                           \
+                node->left = prefix##Rotate(node->left, 1);                             \
+            }                                                                           \
+            return prefix##Rotate(node, 0);                                             \
+        }                                                                               \
+        if (balance < -1)                                                               \
+        {                                                                               \
+            if (prefix##Height(node->right->right) < prefix##Height(node->right->left)) \
+            {                                                                           \
+                node->right = prefix##Rotate(node->right, 0);                           \
+            }                                                                           \
+            return prefix##Rotate(node, 1);                                             \
+        }                                                                               \
+        return node;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    Type##Node *prefix##InsertAt(Type##Node *node, T item, int *added)                  \
+    {                                                                                   \
+        if (node == NULL)                                                               \
+        {                                                                               \
+            Type##Node *leaf = (Type##Node *)poolAlloc(&prefix##Pool);                  \
+            leaf->data = item;                                                          \
+            leaf->height = 1;                                                           \
+            leaf->left = leaf->right = NULL;                                            \
+            *added = 1;                                                                 \
+            return leaf;                                                                \
+        }                                                                               \
+        int order = COMPARE(item, node->data);                                          \
+        if (order == 0)                                                                 \
+        {                                                                               \
+            node->data = item;                                                          \
+            return node;                                                                \
+        }                                                                               \
+        if (order < 0)                                                                  \
+        {                                                                               \
+            node->left = prefix##InsertAt(node->left, item, added);                     \
+        }                                                                               \
+        else                                                                            \
+        {                                                                               \
+            node->right = prefix##InsertAt(node->right, item, added);                   \
+        }                                                                               \
+        return prefix##Rebalance(node);                                                 \
+    }                                                                                   \
+                                                                                        \
+    int prefix##Insert(Type *tree, T item)                                              \
+    {                                                                                   \
+        int added = 0;                                                                  \
+        tree->root = prefix##InsertAt(tree->root, item, &added);                        \
+        tree->size += added;                                                            \
+        return added;                                                                   \
+    }                                                                                   \
+                                                                                        \
+    T *prefix##Find(Type *tree, T probe)                                                \
+    {                                                                                   \
+        Type##Node *node = tree->root;                                                  \
+        while (node != NULL)                                                            \
+        {                                                                               \
+            int order = COMPARE(probe, node->data);                                     \
+            if (order == 0)                                                             \
+            {                                                                           \
+                return &node->data;                                                     \
+            }                                                                           \
+            node = order < 0 ? node->left : node->right;                                \
+        }                                                                               \
+        return NULL;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    Type##Node *prefix##DeleteAt(Type##Node *node, T probe, int *deleted)               \
+    {                                                                                   \
+        if (node == NULL)                                                               \
+        {                                                                               \
+            return NULL;                                                                \
+        }                                                                               \
+        int order = COMPARE(probe, node->data);                                         \
+        if (order < 0)                                                                  \
+        {                                                                               \
+            node->left = prefix##DeleteAt(node->left, probe, deleted);                  \
+        }                                                                               \
+        else if (order > 0)                                                             \
+        {                                                                               \
+            node->right = prefix##DeleteAt(node->right, probe, deleted);                \
+        }                                                                               \
+        else if (node->left == NULL || node->right == NULL)                             \
+        {                                                                               \
+            Type##Node *child = node->left != NULL ? node->left : node->right;          \
+            poolFree(&prefix##Pool, node);                                              \
+            *deleted = 1;                                                               \
+            return child;                                                               \
+        }                                                                               \
+        else                                                                            \
+        {                                                                               \
+            Type##Node *successor = node->right;                                        \
+            while (successor->left != NULL)                                             \
+            {                                                                           \
+                successor = successor->left;                                            \
+            }                                                                           \
+            node->data = successor->data;                                               \
+            node->right = prefix##DeleteAt(node->right, successor->data, deleted);      \
+        }                                                                               \
+        return prefix##Rebalance(node);                                                 \
+    }                                                                                   \
+                                                                                        \
+    int prefix##Delete(Type *tree, T probe)                                             \
+    {                                                                                   \
+        int deleted = 0;                                                                \
+        tree->root = prefix##DeleteAt(tree->root, probe, &deleted);                     \
+        tree->size -= deleted;                                                          \
+        return deleted;                                                                 \
+    }                                                                                   \
+                                                                                        \
+    void prefix##WalkFrom(Type##Node *node, void (*visit)(T *, void *), void *context)  \
+    {                                                                                   \
+        while (node != NULL)                                                            \
+        {                                                                               \
+            prefix##WalkFrom(node->left, visit, context);                               \
+            visit(&node->data, context);                                                \
+            node = node->right;                                                         \
+        }                                                                               \
+    }                                                                                   \
+                                                                                        \
+    void prefix##Walk(Type *tree, void (*visit)(T *, void *), void *context)            \
+    {                                                                                   \
+        prefix##WalkFrom(tree->root, visit, context);                                   \
+    }                                                                                   \
+                                                                                        \
+    void prefix##FreeAll(void)                                                          \
+    {                                                                                   \
+        poolDestroy(&prefix##Pool);                                                     \
+    }
+
+DEFINE_LIST(ListI64, listI64, int64_t, COMPARE_NUMBER)
+DEFINE_LIST(ListU32, listU32, uint32_t, COMPARE_NUMBER)
+DEFINE_LIST(ListF64, listF64, double, COMPARE_NUMBER)
+DEFINE_LIST(ListStr, listStr, KeyString, COMPARE_KEY_STRING)
+DEFINE_LIST(ListKv, listKv, KeyPayload, COMPARE_KEY_PAYLOAD)
+
+DEFINE_STACK(StackI64, stackI64, int64_t)
+DEFINE_STACK(StackU32, stackU32, uint32_t)
+DEFINE_STACK(StackF64, stackF64, double)
+DEFINE_STACK(StackStr, stackStr, KeyString)
+DEFINE_STACK(StackKv, stackKv, KeyPayload)
+
+DEFINE_QUEUE(QueueI64, queueI64, int64_t)
+DEFINE_QUEUE(QueueU32, queueU32, uint32_t)
+DEFINE_QUEUE(QueueF64, queueF64, double)
+DEFINE_QUEUE(QueueStr, queueStr, KeyString)
+DEFINE_QUEUE(QueueKv, queueKv, KeyPayload)
+
+DEFINE_TREE(TreeI64, treeI64, int64_t, COMPARE_NUMBER)
+DEFINE_TREE(TreeU32, treeU32, uint32_t, COMPARE_NUMBER)
+DEFINE_TREE(TreeF64, treeF64, double, COMPARE_NUMBER)
+DEFINE_TREE(TreeStr, treeStr, KeyString, COMPARE_KEY_STRING)
+DEFINE_TREE(TreeKv, treeKv, KeyPayload, COMPARE_KEY_PAYLOAD)
+
+#ifndef _WIN32
+// Lock-free Queue Functions------------------------------------------------------------
+
+// Busy-waits briefly, then yields, so a blocked thread does not burn a whole
+// core (or starve its partner when both share one)
+void backoffWait(int *spins)
+{
+    if (++*spins < 64)
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+    else
+    {
+        *spins = 0;
+        sched_yield();
+    }
+}
+
+SpscQueue *createSpscQueue(size_t capacity, size_t publishBatch)
+{
+    size_t size = 2;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    SpscQueue *queue = (SpscQueue *)aligned_alloc(CACHE_LINE_SIZE, sizeof(SpscQueue));
+    int *array = (int *)malloc(size * sizeof(int));
+    if (queue == NULL || array == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    queue->tailLocal = queue->headCache = 0;
+    queue->headLocal = queue->tailCache = 0;
+    queue->array = array;
+    queue->mask = size - 1;
+    queue->publishBatch = publishBatch > 0 ? publishBatch : 1;
+    return queue;
+}
+
+void freeSpscQueue(SpscQueue *queue)
+{
+    free(queue->array);
+    free(queue);
+}
+
+// Producer side: makes every written item visible to the consumer
+void spscFlush(SpscQueue *queue)
+{
+    atomic_store_explicit(&queue->tail, queue->tailLocal, memory_order_release);
+}
+
+// Consumer side: hands every consumed slot back to the producer
+void spscRelease(SpscQueue *queue)
+{
+    atomic_store_explicit(&queue->head, queue->headLocal, memory_order_release);
+}
+
+// Producer only. Returns 0 when the ring is full. Items are published every
+// publishBatch writes (or when the ring fills); call spscFlush when idle
+int spscTryEnqueue(SpscQueue *queue, int item)
+{
+    size_t tail = queue->tailLocal;
+    if (tail - queue->headCache > queue->mask)
+    {
+        queue->headCache = atomic_load_explicit(&queue->head, memory_order_acquire);
+        if (tail - queue->headCache > queue->mask)
+        {
+            spscFlush(queue); // Let a waiting consumer drain what we wrote
+            return 0;
+        }
+    }
+
+    queue->array[tail & queue->mask] = item;
+    queue->tailLocal = tail + 1;
+    if (queue->tailLocal - atomic_load_explicit(&queue->tail, memory_order_relaxed) >= queue->publishBatch)
+    {
+        spscFlush(queue);
+    }
+    return 1;
+}
+
+// Consumer only. Returns 0 when no published item is available
+int spscTryDequeue(SpscQueue *queue, int *item)
+{
+    size_t head = queue->headLocal;
+    if (head == queue->tailCache)
+    {
+        queue->tailCache = atomic_load_explicit(&queue->tail, memory_order_acquire);
+        if (head == queue->tailCache)
+        {
+            spscRelease(queue); // Let a waiting producer reuse our slots
+            return 0;
+        }
+    }
+
+    *item = queue->array[head & queue->mask];
+    queue->headLocal = head + 1;
+    if (queue->headLocal - atomic_load_explicit(&queue->head, memory_order_relaxed) >= queue->publishBatch)
+    {
+        spscRelease(queue);
+    }
+    return 1;
+}
+
+// Producer only. Copies as many items as fit and publishes them at once
+size_t spscEnqueueBulk(SpscQueue *queue, const int *items, size_t count)
+{
+    size_t tail = queue->tailLocal;
+    size_t capacity = queue->mask + 1;
+    if (capacity - (tail - queue->headCache) < count)
+    {
+        queue->headCache = atomic_load_explicit(&queue->head, memory_order_acquire);
+    }
+
+    size_t space = capacity - (tail - queue->headCache);
+    if (count > space)
+    {
+        count = space;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        queue->array[(tail + i) & queue->mask] = items[i];
+    }
+    queue->tailLocal = tail + count;
+    spscFlush(queue);
+    return count;
+}
+
+// Consumer only. Takes up to max published items and releases their slots
+size_t spscDequeueBulk(SpscQueue *queue, int *items, size_t max)
+{
+    size_t head = queue->headLocal;
+    if (queue->tailCache - head < max)
+    {
+        queue->tailCache = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    }
+
+    size_t count = queue->tailCache - head;
+    if (count > max)
+    {
+        count = max;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        items[i] = queue->array[(head + i) & queue->mask];
+    }
+    queue->headLocal = head + count;
+    spscRelease(queue);
+    return count;
+}
+
+MpmcQueue *createMpmcQueue(size_t capacity)
+{
+    size_t size = 2;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    MpmcQueue *queue = (MpmcQueue *)aligned_alloc(CACHE_LINE_SIZE, sizeof(MpmcQueue));
+    MpmcCell *cells = (MpmcCell *)malloc(size * sizeof(MpmcCell));
+    if (queue == NULL || cells == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0; i < size; i++)
+    {
+        atomic_init(&cells[i].sequence, i);
+    }
+    atomic_init(&queue->enqueuePos, 0);
+    atomic_init(&queue->dequeuePos, 0);
+    queue->cells = cells;
+    queue->mask = size - 1;
+    return queue;
+}
+
+void freeMpmcQueue(MpmcQueue *queue)
+{
+    free(queue->cells);
+    free(queue);
+}
+
+// Any thread. Returns 0 when the ring is full
+int mpmcTryEnqueue(MpmcQueue *queue, int item)
+{
+    size_t pos = atomic_load_explicit(&queue->enqueuePos, memory_order_relaxed);
+    for (;;)
+    {
+        MpmcCell *cell = &queue->cells[pos & queue->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+        if (diff == 0)
+        {
+            // The cell is free for this lap; try to claim it
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueuePos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                cell->data = item;
+                atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+                return 1;
+            }
+        }
+        else if (diff < 0)
+        {
+            return 0; // Still holds last lap's item: the ring is full
+        }
+        else
+        {
+            pos = atomic_load_explicit(&queue->enqueuePos, memory_order_relaxed);
+        }
+    }
+}
+
+// Any thread. Returns 0 when the ring is empty
+int mpmcTryDequeue(MpmcQueue *queue, int *item)
+{
+    size_t pos = atomic_load_explicit(&queue->dequeuePos, memory_order_relaxed);
+    for (;;)
+    {
+        MpmcCell *cell = &queue->cells[pos & queue->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&queue->dequeuePos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                *item = cell->data;
+                // Hand the cell to the producer one lap ahead
+                atomic_store_explicit(&cell->sequence, pos + queue->mask + 1, memory_order_release);
+                return 1;
+            }
+        }
+        else if (diff < 0)
+        {
+            return 0;
+        }
+        else
+        {
+            pos = atomic_load_explicit(&queue->dequeuePos, memory_order_relaxed);
+        }
+    }
+}
+
+// Blocking variants: wait (spinning, then yielding) until there is room/an item
+void mpmcEnqueue(MpmcQueue *queue, int item)
+{
+    int spins = 0;
+    while (!mpmcTryEnqueue(queue, item))
+    {
+        backoffWait(&spins);
+    }
+}
+
+int mpmcDequeue(MpmcQueue *queue)
+{
+    int item, spins = 0;
+    while (!mpmcTryDequeue(queue, &item))
+    {
+        backoffWait(&spins);
+    }
+    return item;
+}
+
+MsNode *createMsNode(int data)
+{
+    MsNode *node = (MsNode *)malloc(sizeof(MsNode));
+    if (node == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    atomic_init(&node->next, NULL);
+    node->data = data;
+    return node;
+}
+
+MsQueue *createMsQueue()
+{
+    MsQueue *queue = (MsQueue *)aligned_alloc(CACHE_LINE_SIZE, sizeof(MsQueue));
+    if (queue == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    MsNode *dummy = createMsNode(0); // Head always points at a consumed dummy
+    atomic_init(&queue->head, dummy);
+    atomic_init(&queue->tail, dummy);
+    for (int i = 0; i < HAZARD_MAX_THREADS; i++)
+    {
+        HazardRecord *record = &queue->records[i];
+        for (int h = 0; h < HAZARD_PER_THREAD; h++)
+        {
+            atomic_init(&record->hazard[h], NULL);
+        }
+        atomic_init(&record->active, 0);
+        record->retired = NULL;
+        record->retiredCount = 0;
+    }
+    return queue;
+}
+
+// Claims a hazard record for the calling thread; pass it to every operation
+HazardRecord *msQueueAttach(MsQueue *queue)
+{
+    for (int i = 0; i < HAZARD_MAX_THREADS; i++)
+    {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&queue->records[i].active, &expected, 1))
+        {
+            HazardRecord *record = &queue->records[i];
+            if (record->retired == NULL)
+            {
+                record->retired = (MsNode **)malloc(HAZARD_SCAN_THRESHOLD * sizeof(MsNode *));
+                if (record->retired == NULL)
+                {
+                    fprintf(stderr, "Memory allocation failed!\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            return record;
+        }
+    }
+    fprintf(stderr, "Too many threads attached to one MsQueue!\n");
+    exit(EXIT_FAILURE);
+}
+
+// Gives the record back. Nodes it still has retired are kept for the next
+// owner or for freeMsQueue
+void msQueueDetach(HazardRecord *record)
+{
+    for (int h = 0; h < HAZARD_PER_THREAD; h++)
+    {
+        atomic_store(&record->hazard[h], NULL);
+    }
+    atomic_store(&record->active, 0);
+}
+
+int comparePointers(const void *a, const void *b)
+{
+    uintptr_t x = *(const uintptr_t *)a;
+    uintptr_t y = *(const uintptr_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Frees every retired node that no thread has published as a hazard
+void msScanRetired(MsQueue *queue, HazardRecord *record)
+{
+    uintptr_t hazards[HAZARD_MAX_THREADS * HAZARD_PER_THREAD];
+    int hazardCount = 0;
+    for (int i = 0; i < HAZARD_MAX_THREADS; i++)
+    {
+        for (int h = 0; h < HAZARD_PER_THREAD; h++)
+        {
+            MsNode *node = atomic_load(&queue->records[i].hazard[h]);
+            if (node != NULL)
+            {
+                hazards[hazardCount++] = (uintptr_t)node;
+            }
+        }
+    }
+    qsort(hazards, hazardCount, sizeof(uintptr_t), comparePointers);
+
+    int kept = 0;
+    for (int i = 0; i < record->retiredCount; i++)
+    {
+        uintptr_t node = (uintptr_t)record->retired[i];
+        if (bsearch(&node, hazards, hazardCount, sizeof(uintptr_t), comparePointers) != NULL)
+        {
+            record->retired[kept++] = record->retired[i];
+        }
+        else
+        {
+            free(record->retired[i]);
+        }
+    }
+    record->retiredCount = kept;
+}
+
+void msRetire(MsQueue *queue, HazardRecord *record, MsNode *node)
+{
+    record->retired[record->retiredCount++] = node;
+    if (record->retiredCount == HAZARD_SCAN_THRESHOLD)
+    {
+        // At most HAZARD_MAX_THREADS * HAZARD_PER_THREAD survive, so a scan
+        // always makes room
+        msScanRetired(queue, record);
+    }
+}
+
+// Any attached thread. Never fails: the queue grows node by node
+void msEnqueue(MsQueue *queue, HazardRecord *record, int item)
+{
+    MsNode *node = createMsNode(item);
+    for (;;)
+    {
+        MsNode *tail = atomic_load(&queue->tail);
+        atomic_store(&record->hazard[0], tail);
+        if (tail != atomic_load(&queue->tail))
+        {
+            continue; // Tail moved before our hazard became visible
+        }
+
+        MsNode *next = atomic_load(&tail->next);
+        if (next != NULL)
+        {
+            atomic_compare_exchange_strong(&queue->tail, &tail, next); // Help a lagging tail
+            continue;
+        }
+
+        MsNode *expected = NULL;
+        if (atomic_compare_exchange_strong(&tail->next, &expected, node))
+        {
+            atomic_compare_exchange_strong(&queue->tail, &tail, node);
+            break;
+        }
+    }
+    atomic_store_explicit(&record->hazard[0], NULL, memory_order_release);
+}
+
+// Any attached thread. Returns 0 when the queue is empty
+int msTryDequeue(MsQueue *queue, HazardRecord *record, int *item)
+{
+    MsNode *head;
+    for (;;)
+    {
+        head = atomic_load(&queue->head);
+        atomic_store(&record->hazard[0], head);
+        if (head != atomic_load(&queue->head))
+        {
+            continue;
+        }
+
+        MsNode *tail = atomic_load(&queue->tail);
+        MsNode *next = atomic_load(&head->next);
+        atomic_store(&record->hazard[1], next);
+        if (head != atomic_load(&queue->head))
+        {
+            continue;
+        }
+
+        if (next == NULL)
+        {
+            atomic_store_explicit(&record->hazard[0], NULL, memory_order_release);
+            return 0;
+        }
+        if (head == tail)
+        {
+            atomic_compare_exchange_strong(&queue->tail, &tail, next);
+            continue;
+        }
+
+        int data = next->data; // Safe: next is protected by hazard[1]
+        if (atomic_compare_exchange_strong(&queue->head, &head, next))
+        {
+            *item = data;
+            break;
+        }
+    }
+
+    atomic_store_explicit(&record->hazard[0], NULL, memory_order_release);
+    atomic_store_explicit(&record->hazard[1], NULL, memory_order_release);
+    msRetire(queue, record, head); // The old dummy; next becomes the new one
+    return 1;
+}
+
+// Blocking variant: waits until an item arrives
+int msDequeue(MsQueue *queue, HazardRecord *record)
+{
+    int item, spins = 0;
+    while (!msTryDequeue(queue, record, &item))
+    {
+        backoffWait(&spins);
+    }
+    return item;
+}
+
+// Only call once every thread has stopped using the queue
+void freeMsQueue(MsQueue *queue)
+{
+    MsNode *node = atomic_load(&queue->head);
+    while (node != NULL)
+    {
+        MsNode *next = atomic_load(&node->next);
+        free(node);
+        node = next;
+    }
+    for (int i = 0; i < HAZARD_MAX_THREADS; i++)
+    {
+        HazardRecord *record = &queue->records[i];
+        for (int r = 0; r < record->retiredCount; r++)
+        {
+            free(record->retired[r]);
+        }
+        free(record->retired);
+    }
+    free(queue);
+}
+#endif
+
+#ifndef _WIN32
+// Lock-free Stack Functions------------------------------------------------------------
+
+// Per-thread generator for picking elimination slots
+_Thread_local unsigned long long eliminationSeed = 0;
+
+TreiberStack *createTreiberStack(uint32_t capacity, int eliminationSize)
+{
+    TreiberStack *stack = (TreiberStack *)aligned_alloc(CACHE_LINE_SIZE, sizeof(TreiberStack));
+    TreiberNode *nodes = (TreiberNode *)malloc((capacity > 0 ? capacity : 1) * sizeof(TreiberNode));
+    EliminationSlot *slots = NULL;
+    if (eliminationSize > 0)
+    {
+        slots = (EliminationSlot *)aligned_alloc(CACHE_LINE_SIZE, eliminationSize * sizeof(EliminationSlot));
+    }
+    if (stack == NULL || nodes == NULL || (eliminationSize > 0 && slots == NULL))
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Thread every node onto the free list
+    for (uint32_t i = 0; i < capacity; i++)
+    {
+        nodes[i].data = 0;
+        atomic_init(&nodes[i].next, i + 1 < capacity ? i + 1 : TREIBER_NIL);
+    }
+    for (int i = 0; i < eliminationSize; i++)
+    {
+        atomic_init(&slots[i].value, 0);
+    }
+    atomic_init(&stack->head, TREIBER_NIL);
+    atomic_init(&stack->freeHead, capacity > 0 ? 0 : TREIBER_NIL);
+    stack->nodes = nodes;
+    stack->capacity = capacity;
+    stack->elimination = slots;
+    stack->eliminationSize = eliminationSize > 0 ? eliminationSize : 0;
+    return stack;
+}
+
+void freeTreiberStack(TreiberStack *stack)
+{
+    free(stack->elimination);
+    free(stack->nodes);
+    free(stack);
+}
+
+// One CAS attempt to link node `index` on top of `head`. Returns 0 if another
+// thread changed the head first
+int treiberLink(_Atomic uint64_t *head, TreiberNode *nodes, uint32_t index)
+{
+    uint64_t top = atomic_load_explicit(head, memory_order_relaxed);
+    atomic_store_explicit(&nodes[index].next, (uint32_t)top, memory_order_relaxed);
+    uint64_t next = (((top >> 32) + 1) << 32) | index;
+    return atomic_compare_exchange_strong_explicit(head, &top, next, memory_order_release, memory_order_relaxed);
+}
+
+// One CAS attempt to unlink the top node. Returns its index, TREIBER_NIL when
+// the stack is empty, or TREIBER_NIL - 1 when another thread won the race
+uint32_t treiberUnlink(_Atomic uint64_t *head, TreiberNode *nodes)
+{
+    uint64_t top = atomic_load_explicit(head, memory_order_acquire);
+    uint32_t index = (uint32_t)top;
+    if (index == TREIBER_NIL)
+    {
+        return TREIBER_NIL;
+    }
+
+    // May read a node that was just recycled; the tag then makes the CAS fail
+    uint32_t below = atomic_load_explicit(&nodes[index].next, memory_order_relaxed);
+    uint64_t next = (((top >> 32) + 1) << 32) | below;
+    if (atomic_compare_exchange_strong_explicit(head, &top, next, memory_order_acquire, memory_order_relaxed))
+    {
+        return index;
+    }
+    return TREIBER_NIL - 1;
+}
+
+// Free-list helpers: these retry until they win, since the list is never
+// contended for long
+uint32_t treiberTakeNode(TreiberStack *stack)
+{
+    uint32_t index;
+    while ((index = treiberUnlink(&stack->freeHead, stack->nodes)) == TREIBER_NIL - 1)
+    {
+    }
+    return index;
+}
+
+void treiberReturnNode(TreiberStack *stack, uint32_t index)
+{
+    while (!treiberLink(&stack->freeHead, stack->nodes, index))
+    {
+    }
+}
+
+_Atomic uint64_t *randomEliminationSlot(TreiberStack *stack)
+{
+    if (eliminationSeed == 0)
+    {
+        eliminationSeed = (unsigned long long)nowNanos() ^ (uintptr_t)&eliminationSeed;
+    }
+    return &stack->elimination[nextRandom(&eliminationSeed) % stack->eliminationSize].value;
+}
+
+// Pusher side: offers the item in a random slot and waits briefly for a
+// popper. Only pushers wait, so a slot never holds two offers
+int eliminatePush(TreiberStack *stack, int item)
+{
+    _Atomic uint64_t *slot = randomEliminationSlot(stack);
+    uint64_t expected = 0;
+    uint64_t offer = ELIMINATION_OFFER | (uint32_t)item;
+    if (!atomic_compare_exchange_strong(slot, &expected, offer))
+    {
+        return 0;
+    }
+
+    for (int spin = 0; spin < ELIMINATION_SPINS; spin++)
+    {
+        if (atomic_load_explicit(slot, memory_order_acquire) == ELIMINATION_TAKEN)
+        {
+            atomic_store_explicit(slot, 0, memory_order_release);
+            return 1;
+        }
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    // Withdraw the offer, unless a popper took it at the last moment
+    expected = offer;
+    if (atomic_compare_exchange_strong(slot, &expected, 0))
+    {
+        return 0;
+    }
+    atomic_store_explicit(slot, 0, memory_order_release);
+    return 1;
+}
+
+// Popper side: takes a waiting pusher's offer if the random slot holds one
+int eliminatePop(TreiberStack *stack, int *item)
+{
+    _Atomic uint64_t *slot = randomEliminationSlot(stack);
+    uint64_t value = atomic_load_explicit(slot, memory_order_acquire);
+    if ((value & ~0xffffffffull) != ELIMINATION_OFFER)
+    {
+        return 0;
+    }
+    if (atomic_compare_exchange_strong(slot, &value, ELIMINATION_TAKEN))
+    {
+        *item = (int)(uint32_t)value;
+        return 1;
+    }
+    return 0;
+}
+
+// Any thread. Returns 0 when all `capacity` nodes are in use
+int treiberTryPush(TreiberStack *stack, int item)
+{
+    uint32_t index = treiberTakeNode(stack);
+    if (index == TREIBER_NIL)
+    {
+        return 0;
+    }
+
+    stack->nodes[index].data = item;
+    int spins = 0;
+    while (!treiberLink(&stack->head, stack->nodes, index))
+    {
+        // Lost a race: pair off with a concurrent pop instead of retrying
+        if (stack->eliminationSize > 0 && eliminatePush(stack, item))
+        {
+            treiberReturnNode(stack, index);
+            return 1;
+        }
+        backoffWait(&spins);
+    }
+    return 1;
+}
+
+// Any thread. Returns 0 when the stack is empty
+int treiberTryPop(TreiberStack *stack, int *item)
+{
+    int spins = 0;
+    for (;;)
+    {
+        uint32_t index = treiberUnlink(&stack->head, stack->nodes);
+        if (index == TREIBER_NIL)
+        {
+            return 0;
+        }
+        if (index != TREIBER_NIL - 1)
+        {
+            *item = stack->nodes[index].data;
+            treiberReturnNode(stack, index);
+            return 1;
+        }
+        if (stack->eliminationSize > 0 && eliminatePop(stack, item))
+        {
+            return 1;
+        }
+        backoffWait(&spins);
+    }
+}
+
+// Lock-free Skip List Functions--------------------------------------------------------
+
+// Per-thread level generator, seeded like eliminationSeed
+_Thread_local unsigned long long skipLevelSeed = 0;
+
+LfSkipNode *createLfSkipNode(int key, int level)
+{
+    LfSkipNode *node = (LfSkipNode *)malloc(sizeof(LfSkipNode) + level * sizeof(_Atomic uintptr_t));
+    if (node == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    STAT_ALLOC(STAT_SKIP, sizeof(LfSkipNode) + level * sizeof(_Atomic uintptr_t));
+    node->key = key;
+    node->level = level;
+    node->retiredNext = NULL;
+    for (int i = 0; i < level; i++)
+    {
+        atomic_init(&node->next[i], 0);
+    }
+    return node;
+}
+
+LfSkipList *createLfSkipList()
+{
+    LfSkipList *list = (LfSkipList *)aligned_alloc(CACHE_LINE_SIZE, sizeof(LfSkipList));
+    if (list == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    list->head = createLfSkipNode(0, SKIP_MAX_LEVEL);
+    atomic_init(&list->retired, NULL);
+    return list;
+}
+
+// Only once no thread uses the list: the live keys are the unmarked nodes
+// on level 0 and every removed node is on the retired list
+void freeLfSkipList(LfSkipList *list)
+{
+    uintptr_t word = atomic_load(&list->head->next[0]);
+    while (SKIP_NODE(word) != NULL)
+    {
+        LfSkipNode *node = SKIP_NODE(word);
+        word = atomic_load(&node->next[0]);
+        if ((word & SKIP_MARK) == 0)
+        {
+            free(node);
+        }
+    }
+
+    LfSkipNode *node = atomic_load(&list->retired);
+    while (node != NULL)
+    {
+        LfSkipNode *next = node->retiredNext;
+        free(node);
+        node = next;
+    }
+    free(list->head);
+    free(list);
+}
+
+// One top-down pass of lfSkipFind, unlinking marked nodes on the way.
+// Returns -1 if an unlink failed because the predecessor changed
+int lfSkipFindPass(LfSkipList *list, int key, LfSkipNode **preds, LfSkipNode **succs)
+{
+    LfSkipNode *pred = list->head;
+    for (int level = SKIP_MAX_LEVEL - 1; level >= 0; level--)
+    {
+        LfSkipNode *current = SKIP_NODE(atomic_load(&pred->next[level]));
+        while (current != NULL)
+        {
+            uintptr_t next = atomic_load(&current->next[level]);
+            if (next & SKIP_MARK)
+            {
+                uintptr_t expected = (uintptr_t)current;
+                if (!atomic_compare_exchange_strong(&pred->next[level], &expected, next & ~SKIP_MARK))
+                {
+                    return -1;
+                }
+                current = SKIP_NODE(next);
+            }
+            else if (current->key < key)
+            {
+                pred = current;
+                current = SKIP_NODE(next);
+            }
+            else
+            {
+                break;
+            }
+        }
+        preds[level] = pred;
+        succs[level] = current;
+    }
+    return succs[0] != NULL && succs[0]->key == key;
+}
+
+// Fills preds/succs with the nodes around key on every level. Returns
+// whether an unmarked node holds key
+int lfSkipFind(LfSkipList *list, int key, LfSkipNode **preds, LfSkipNode **succs)
+{
+    int found;
+    while ((found = lfSkipFindPass(list, key, preds, succs)) < 0)
+        ;
+    return found;
+}
+
+// Any thread. Returns 0 if key is already present. The CAS on level 0 adds
+// the key to the set; the levels above are shortcuts linked afterwards
+int lfSkipInsert(LfSkipList *list, int key)
+{
+    LfSkipNode *preds[SKIP_MAX_LEVEL], *succs[SKIP_MAX_LEVEL];
+    LfSkipNode *node = NULL;
+
+    if (skipLevelSeed == 0)
+    {
+        skipLevelSeed = (unsigned long long)nowNanos() ^ (uintptr_t)&skipLevelSeed;
+    }
+
+    for (;;)
+    {
+        if (lfSkipFind(list, key, preds, succs))
+        {
+            free(node); // Never published
+            return 0;
+        }
+        if (node == NULL)
+        {
+            node = createLfSkipNode(key, randomSkipLevel(&skipLevelSeed));
+        }
+        for (int level = 0; level < node->level; level++)
+        {
+            atomic_store(&node->next[level], (uintptr_t)succs[level]);
+        }
+        uintptr_t expected = (uintptr_t)succs[0];
+        if (atomic_compare_exchange_strong(&preds[0]->next[0], &expected, (uintptr_t)node))
+        {
+            break;
+        }
+    }
+
+    for (int level = 1; level < node->level; level++)
+    {
+        for (;;)
+        {
+            // Aim the node at the current successor first. A mark means a
+            // remover reached this level, so the node goes no higher
+            uintptr_t next = atomic_load(&node->next[level]);
+            if ((next & SKIP_MARK) ||
+                (next != (uintptr_t)succs[level] &&
+                 !atomic_compare_exchange_strong(&node->next[level], &next, (uintptr_t)succs[level])))
+            {
+                return 1;
+            }
+            uintptr_t expected = (uintptr_t)succs[level];
+            if (atomic_compare_exchange_strong(&preds[level]->next[level], &expected, (uintptr_t)node))
+            {
+                break;
+            }
+            lfSkipFind(list, key, preds, succs);
+        }
+    }
+    return 1;
+}
+
+// Any thread. Returns 0 if key is absent. Of several threads removing the
+// same key, only the one that marks level 0 succeeds
+int lfSkipRemove(LfSkipList *list, int key)
+{
+    LfSkipNode *preds[SKIP_MAX_LEVEL], *succs[SKIP_MAX_LEVEL];
+    if (!lfSkipFind(list, key, preds, succs))
+    {
+        return 0;
+    }
+
+    LfSkipNode *node = succs[0];
+    for (int level = node->level - 1; level >= 1; level--)
+    {
+        uintptr_t next = atomic_load(&node->next[level]);
+        while ((next & SKIP_MARK) == 0 &&
+               !atomic_compare_exchange_weak(&node->next[level], &next, next | SKIP_MARK))
+            ;
+    }
+
+    uintptr_t next = atomic_load(&node->next[0]);
+    while ((next & SKIP_MARK) == 0)
+    {
+        if (atomic_compare_exchange_weak(&node->next[0], &next, next | SKIP_MARK))
+        {
+            lfSkipFind(list, key, preds, succs); // Unlinks it on every level
+
+            LfSkipNode *retired = atomic_load(&list->retired);
+            do
+            {
+                node->retiredNext = retired;
+            } while (!atomic_compare_exchange_weak(&list->retired, &retired, node));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Any thread. Never writes or restarts: marked nodes are stepped over
+int lfSkipContains(LfSkipList *list, int key)
+{
+    LfSkipNode *pred = list->head, *current = NULL;
+    for (int level = SKIP_MAX_LEVEL - 1; level >= 0; level--)
+    {
+        current = SKIP_NODE(atomic_load(&pred->next[level]));
+        while (current != NULL)
+        {
+            uintptr_t next = atomic_load(&current->next[level]);
+            if ((next & SKIP_MARK) == 0)
+            {
+                if (current->key >= key)
+                {
+                    break;
+                }
+                pred = current;
+            }
+            current = SKIP_NODE(next);
+        }
+    }
+    return current != NULL && current->key == key;
+}
+
+// Keys in the set; exact only while no thread is modifying it
+long long lfSkipCount(LfSkipList *list)
+{
+    long long count = 0;
+    uintptr_t word = atomic_load(&list->head->next[0]);
+    while (SKIP_NODE(word) != NULL)
+    {
+        word = atomic_load(&SKIP_NODE(word)->next[0]);
+        count += (word & SKIP_MARK) == 0;
+    }
+    return count;
+}
+#endif
+
+// Binary Tree Functions---------------------------------------------------------------
+TreeNode *createTreeNode(int data)
+{
+    TreeNode *newNode = (TreeNode *)poolAlloc(threadTreePool != NULL ? threadTreePool : &treeNodePool);
+    STAT_ALLOC(STAT_TREE, sizeof(TreeNode));
+    newNode->data = data;
+    newNode->height = 1;
+    newNode->left = newNode->right = NULL;
+    return newNode;
+}
+
+int treeHeight(TreeNode *node)
+{
+    return node == NULL ? 0 : node->height;
+}
+
+void updateTreeHeight(TreeNode *node)
+{
+    int left = treeHeight(node->left);
+    int right = treeHeight(node->right);
+    node->height = (left > right ? left : right) + 1;
+}
+
+TreeNode *rotateRight(TreeNode *node)
+{
+    TreeNode *pivot = node->left;
+    node->left = pivot->right;
+    pivot->right = node;
+    updateTreeHeight(node);
+    updateTreeHeight(pivot);
+    return pivot;
+}
+
+TreeNode *rotateLeft(TreeNode *node)
+{
+    TreeNode *pivot = node->right;
+    node->right = pivot->left;
+    pivot->left = node;
+    updateTreeHeight(node);
+    updateTreeHeight(pivot);
+    return pivot;
+}
+
+// Restores the AVL property at node after one of its subtrees changed height
+TreeNode *balanceTreeNode(TreeNode *node)
+{
+    updateTreeHeight(node);
+    int balance = treeHeight(node->left) - treeHeight(node->right);
+
+    if (balance > 1)
+    {
+        if (treeHeight(node->left->left) < treeHeight(node->left->right))
+        {
+            node->left = rotateLeft(node->left);
+        }
+        return rotateRight(node);
+    }
+    if (balance < -1)
+    {
+        if (treeHeight(node->right->right) < treeHeight(node->right->left))
+        {
+            node->right = rotateRight(node->right);
+        }
+        return rotateLeft(node);
+    }
+    return node;
+}
+
+// Recursion depth is bounded by the AVL height, about 1.44 log2(n)
+TreeNode *avlInsert(TreeNode *root, int data)
+{
+    if (root == NULL)
+    {
+        return createTreeNode(data);
+    }
+
+    STAT_ADD(treeInsertVisits, 1);
+    if (data < root->data)
+    {
+        STAT_ADD(treeInsertComparisons, 1);
+        root->left = avlInsert(root->left, data);
+    }
+    else if (data > root->data)
+    {
+        STAT_ADD(treeInsertComparisons, 2);
+        root->right = avlInsert(root->right, data);
+    }
+    else
+    {
+        STAT_ADD(treeInsertComparisons, 2);
+        return root; // Duplicate: nothing changed
+    }
+
+    return balanceTreeNode(root);
+}
+
+TreeNode *insertTreeNode(TreeNode *root, int data)
+{
+    TRACE_BEGIN();
+    STAT_ADD(treeInserts, 1);
+    if (treeMode == TREE_MODE_AVL)
+    {
+        root = avlInsert(root, data);
+        TRACE_END("insertTreeNode");
+        return root;
+    }
+
+    // Iterative so sorted input, which degenerates the tree into a list,
+    // cannot overflow the C stack
+    TreeNode **link = &root;
+    while (*link != NULL)
+    {
+        STAT_ADD(treeInsertVisits, 1);
+        if (data < (*link)->data)
+        {
+            STAT_ADD(treeInsertComparisons, 1);
+            link = &(*link)->left;
+        }
+        else if (data > (*link)->data)
+        {
+            STAT_ADD(treeInsertComparisons, 2);
+            link = &(*link)->right;
+        }
+        else
+        {
+            STAT_ADD(treeInsertComparisons, 2);
+            TRACE_END("insertTreeNode");
+            return root;
+        }
+    }
+    *link = createTreeNode(data);
+
+    TRACE_END("insertTreeNode");
+    return root;
+}
+
+// Returns the node holding key, or NULL
+TreeNode *searchTreeNode(TreeNode *root, int key)
+{
+    while (root != NULL && root->data != key)
+    {
+        root = key < root->data ? root->left : root->right;
+    }
+    return root;
+}
+
+// Looks up count keys, keeping TREE_LOOKUP_LANES searches in flight: each
+// round moves every lane one level down and prefetches the node it will
+// read next round, so the lanes' cache misses overlap instead of queueing.
+// found[i] (if found is not NULL) is set to whether keys[i] is present.
+// Returns how many keys were found
+long long lookupMany(TreeNode *root, const int *keys, long long count, unsigned char *found)
+{
+    TreeNode *node[TREE_LOOKUP_LANES];
+    long long index[TREE_LOOKUP_LANES];
+    long long next = 0, hits = 0;
+    int active = 0;
+
+    for (; active < TREE_LOOKUP_LANES && next < count; active++)
+    {
+        index[active] = next++;
+        node[active] = root;
+    }
+
+    while (active > 0)
+    {
+        for (int lane = 0; lane < active;)
+        {
+            TreeNode *current = node[lane];
+            int key = keys[index[lane]];
+
+            if (current != NULL && current->data != key)
+            {
+                current = key < current->data ? current->left : current->right;
+                PREFETCH(current);
+                node[lane] = current;
+                lane++;
+                continue;
+            }
+
+            // Search over: report it and start the next key in this lane
+            hits += current != NULL;
+            if (found != NULL)
+            {
+                found[index[lane]] = current != NULL;
+            }
+            if (next < count)
+            {
+                index[lane] = next++;
+                node[lane] = root;
+                lane++;
+            }
+            else
+            {
+                // No keys left: retire the lane by moving the last one here
+                active--;
+                index[lane] = index[active];
+                node[lane] = node[active];
+            }
+        }
+    }
+    return hits;
+}
+
+// Recursion depth is bounded by the AVL height, about 1.44 log2(n)
+TreeNode *avlDelete(TreeNode *root, int key, int *deleted)
+{
+    if (root == NULL)
+    {
+        return NULL;
+    }
+
+    if (key < root->data)
+    {
+        root->left = avlDelete(root->left, key, deleted);
+    }
+    else if (key > root->data)
+    {
+        root->right = avlDelete(root->right, key, deleted);
+    }
+    else if (root->left == NULL || root->right == NULL)
+    {
+        TreeNode *child = root->left != NULL ? root->left : root->right;
+        poolFree(&treeNodePool, root);
+        *deleted = 1;
+        return child;
+    }
+    else
+    {
+        // Two children: take the in-order successor's key, then delete the
+        // successor, which has no left child, from the right subtree
+        TreeNode *successor = root->right;
+        while (successor->left != NULL)
+        {
+            successor = successor->left;
+        }
+        root->data = successor->data;
+        root->right = avlDelete(root->right, successor->data, deleted);
+    }
+
+    return balanceTreeNode(root);
+}
+
+// Removes key if present and returns the new root; *deleted is set to 1 if
+// it was found. Iterative in BST mode, like insertTreeNode
+TreeNode *deleteTreeNode(TreeNode *root, int key, int *deleted)
+{
+    *deleted = 0;
+    if (treeMode == TREE_MODE_AVL)
+    {
+        return avlDelete(root, key, deleted);
+    }
+
+    TreeNode **link = &root;
+    while (*link != NULL && (*link)->data != key)
+    {
+        link = key < (*link)->data ? &(*link)->left : &(*link)->right;
+    }
+    if (*link == NULL)
+    {
+        return root;
+    }
+
+    TreeNode *node = *link;
+    if (node->left != NULL && node->right != NULL)
+    {
+        // Two children: unlink the in-order successor and move its key up
+        TreeNode **successor = &node->right;
+        while ((*successor)->left != NULL)
+        {
+            successor = &(*successor)->left;
+        }
+        node->data = (*successor)->data;
+        link = successor;
+        node = *link;
+    }
+
+    *link = node->left != NULL ? node->left : node->right;
+    poolFree(&treeNodePool, node);
+    *deleted = 1;
+    return root;
+}
+
+// Collects the nodes in key order without recursion; *count receives the size
+TreeNode **collectTreeNodes(TreeNode *root, long long *count)
+{
+    long long capacity = 64, size = 0, depth = 0, stackCapacity = 64;
+    TreeNode **nodes = (TreeNode **)malloc(capacity * sizeof(TreeNode *));
+    TreeNode **stack = (TreeNode **)malloc(stackCapacity * sizeof(TreeNode *));
+
+    TreeNode *current = root;
+    while (current != NULL || depth > 0)
+    {
+        while (current != NULL)
+        {
+            if (depth == stackCapacity)
+            {
+                stackCapacity *= 2;
+                stack = (TreeNode **)realloc(stack, stackCapacity * sizeof(TreeNode *));
+            }
+            if (stack == NULL)
+            {
+                fprintf(stderr, "Memory allocation failed!\n");
+                exit(EXIT_FAILURE);
+            }
+            stack[depth++] = current;
+            current = current->left;
+        }
+
+        current = stack[--depth];
+        if (size == capacity)
+        {
+            capacity *= 2;
+            nodes = (TreeNode **)realloc(nodes, capacity * sizeof(TreeNode *));
+        }
+        if (nodes == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+        nodes[size++] = current;
+        current = current->right;
+    }
+
+    free(stack);
+    *count = size;
+    return nodes;
+}
+
+// Relinks sorted nodes[low..high) into a perfectly balanced subtree
+TreeNode *linkBalancedTree(TreeNode **nodes, long long low, long long high)
+{
+    if (low >= high)
+    {
+        return NULL;
+    }
+
+    long long middle = low + (high - low) / 2;
+    TreeNode *node = nodes[middle];
+    node->left = linkBalancedTree(nodes, low, middle);
+    node->right = linkBalancedTree(nodes, middle + 1, high);
+    updateTreeHeight(node);
+    return node;
+}
+
+// Reshapes any BST into a balanced one in O(n), reusing its nodes. Needed
+// when entering AVL mode, because plain BST inserts leave heights stale
+TreeNode *rebalanceTree(TreeNode *root)
+{
+    long long count;
+    TreeNode **nodes = collectTreeNodes(root, &count);
+    root = linkBalancedTree(nodes, 0, count);
+    free(nodes);
+    return root;
+}
+
+// Sideways tree view. Nodes `depth` levels below root are not expanded:
+// each is drawn as one summary line for its whole subtree
+void visualizeBinaryTree(TreeNode *root, int space, int depth)
+{
+    if (root == NULL)
+    {
+        return;
+    }
+
+    space += 5;
+
+    if (depth == 0)
+    {
+        char count[32];
+        long long size = countTreeNodesCapped(root, TREE_VIEW_COUNT_CAP);
+
+        framePrintf("\n");
+        for (int i = 5; i < space; i++)
+        {
+            framePrintf(" ");
+        }
+        framePrintf("[%d ... %s%s more]", root->data, formatCount(count, sizeof(count), size - 1),
+                    size == TREE_VIEW_COUNT_CAP ? "+" : "");
+        return;
+    }
+
+    visualizeBinaryTree(root->right, space, depth - 1);
+
+    framePrintf("\n");
+    for (int i = 5; i < space; i++)
+    {
+        framePrintf(" ");
+    }
+
+#ifdef _WIN32
+    frameColor(GREEN);
+#else
+    frameColor(GREEN);
+#endif
+
+    framePrintf("[%d]", root->data);
+
+#ifdef _WIN32
+    frameColor(RESET);
+#else
+    frameColor(RESET);
+#endif
+
+    visualizeBinaryTree(root->left, space, depth - 1);
+}
+
+// Deepest level to expand so the view takes at most `rows` lines, found by
+// walking level by level from the top (never more than rows + 1 nodes). Each
+// summary line stands for one node just below the last expanded level
+int treeViewDepth(TreeNode *root, int rows)
+{
+    TreeNode **nodes = (TreeNode **)malloc((rows + 1) * sizeof(TreeNode *));
+    if (nodes == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int levels = 0, levelStart = 0, levelEnd = 0, exhausted = 0;
+    if (root != NULL)
+    {
+        nodes[levelEnd++] = root;
+    }
+    for (;;)
+    {
+        if (levelStart == levelEnd)
+        {
+            exhausted = 1; // Every level fits
+            break;
+        }
+        levels++;
+
+        int next = levelEnd;
+        for (int i = levelStart; i < levelEnd && next <= rows; i++)
+        {
+            if (nodes[i]->left != NULL && next <= rows)
+            {
+                nodes[next++] = nodes[i]->left;
+            }
+            if (nodes[i]->right != NULL && next <= rows)
+            {
+                nodes[next++] = nodes[i]->right;
+            }
+        }
+        if (next > rows)
+        {
+            break; // The next level would not fit
+        }
+        levelStart = levelEnd;
+        levelEnd = next;
+    }
+    free(nodes);
+
+    // Keep the last level that fits for the summary lines
+    if (exhausted)
+    {
+        return levels;
+    }
+    return levels > 1 ? levels - 1 : 1;
+}
+
+// Shows the focused subtree (or the whole tree) cut to the screen height
+void visualizeTreeViewport(TreeNode *root, int reservedRows)
+{
+    TreeNode *focus = root;
+    if (treeViewFocused)
+    {
+        while (focus != NULL && focus->data != treeViewKey)
+        {
+            focus = treeViewKey < focus->data ? focus->left : focus->right;
+        }
+        if (focus == NULL)
+        {
+            treeViewFocused = 0; // The key is gone; fall back to the root
+            focus = root;
+        }
+        else
+        {
+            framePrintf("\t(Subtree of %d)\n", treeViewKey);
+        }
+    }
+    visualizeBinaryTree(focus, 0, treeViewDepth(focus, viewRows(reservedRows)));
+}
+
+// Tree Cursor Functions----------------------------------------------------------------
+void treeCursorPush(TreeCursor *cursor, TreeNode *node)
+{
+    if (cursor->count == cursor->capacity)
+    {
+        // A level-order queue first reclaims the slots it already consumed
+        if (cursor->head > 0)
+        {
+            memmove(cursor->nodes, cursor->nodes + cursor->head, (cursor->count - cursor->head) * sizeof(TreeNode *));
+            cursor->count -= cursor->head;
+            cursor->head = 0;
+        }
+        if (cursor->count == cursor->capacity)
+        {
+            cursor->capacity *= 2;
+            cursor->nodes = (TreeNode **)realloc(cursor->nodes, cursor->capacity * sizeof(TreeNode *));
+            if (cursor->nodes == NULL)
+            {
+                fprintf(stderr, "Memory allocation failed!\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    cursor->nodes[cursor->count++] = node;
+}
+
+void treeCursorInit(TreeCursor *cursor, TreeNode *root, int order)
+{
+    cursor->order = order;
+    cursor->current = NULL;
+    cursor->lastVisited = NULL;
+    cursor->head = 0;
+    cursor->count = 0;
+    cursor->capacity = 64;
+    cursor->nodes = (TreeNode **)malloc(cursor->capacity * sizeof(TreeNode *));
+    if (cursor->nodes == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (order == TREE_ORDER_INORDER || order == TREE_ORDER_POSTORDER)
+    {
+        cursor->current = root;
+    }
+    else if (root != NULL)
+    {
+        treeCursorPush(cursor, root);
+    }
+}
+
+// Stores the next key in *value and returns 1, or returns 0 once the
+// traversal is finished
+int treeCursorNext(TreeCursor *cursor, int *value)
+{
+    TreeNode *node;
+
+    switch (cursor->order)
+    {
+    case TREE_ORDER_INORDER:
+        while (cursor->current != NULL)
+        {
+            treeCursorPush(cursor, cursor->current);
+            cursor->current = cursor->current->left;
+        }
+        if (cursor->count == 0)
+        {
+            return 0;
+        }
+        node = cursor->nodes[--cursor->count];
+        cursor->current = node->right;
+        break;
+
+    case TREE_ORDER_PREORDER:
+        if (cursor->count == 0)
+        {
+            return 0;
+        }
+        node = cursor->nodes[--cursor->count];
+        if (node->right != NULL)
+        {
+            treeCursorPush(cursor, node->right);
+        }
+        if (node->left != NULL)
+        {
+            treeCursorPush(cursor, node->left);
+        }
+        break;
+
+    case TREE_ORDER_POSTORDER:
+        for (;;)
+        {
+            while (cursor->current != NULL)
+            {
+                treeCursorPush(cursor, cursor->current);
+                cursor->current = cursor->current->left;
+            }
+            if (cursor->count == 0)
+            {
+                return 0;
+            }
+
+            node = cursor->nodes[cursor->count - 1];
+            if (node->right != NULL && cursor->lastVisited != node->right)
+            {
+                cursor->current = node->right; // Finish the right subtree first
+                continue;
+            }
+            cursor->count--;
+            cursor->lastVisited = node;
+            break;
+        }
+        break;
+
+    default: // TREE_ORDER_LEVEL
+        if (cursor->head == cursor->count)
+        {
+            return 0;
+        }
+        node = cursor->nodes[cursor->head++];
+        if (node->left != NULL)
+        {
+            treeCursorPush(cursor, node->left);
+        }
+        if (node->right != NULL)
+        {
+            treeCursorPush(cursor, node->right);
+        }
+        break;
+    }
+
+    *value = node->data;
+    return 1;
+}
+
+void treeCursorFree(TreeCursor *cursor)
+{
+    free(cursor->nodes);
+    cursor->nodes = NULL;
+    cursor->count = cursor->capacity = cursor->head = 0;
+}
+
+// Callback form of the cursor: visit() receives every key in the given order
+void treeWalk(TreeNode *root, int order, void (*visit)(int, void *), void *context)
+{
+    static const char *traceNames[4] = {"inorderTraversal", "preorderTraversal", "postorderTraversal",
+                                        "levelorderTraversal"};
+    TreeCursor cursor;
+    int value;
+
+    TRACE_BEGIN();
+    treeCursorInit(&cursor, root, order);
+    while (treeCursorNext(&cursor, &value))
+    {
+        visit(value, context);
+    }
+    treeCursorFree(&cursor);
+    TRACE_END(traceNames[order]);
+}
+
+// Subtree size, but gives up at `cap` so a summary costs bounded time
+long long countTreeNodesCapped(TreeNode *root, long long cap)
+{
+    TreeCursor cursor;
+    long long count = 0;
+    int value;
+
+    treeCursorInit(&cursor, root, TREE_ORDER_PREORDER);
+    while (count < cap && treeCursorNext(&cursor, &value))
+    {
+        count++;
+    }
+    treeCursorFree(&cursor);
+    return count;
+}
+
+// Inorder walk in O(1) extra memory (Morris threading): each left subtree's
+// rightmost node temporarily points back at its successor. The tree is
+// restored by the time the walk returns, but must not be read or changed by
+// anyone else meanwhile
+void morrisInorderWalk(TreeNode *root, void (*visit)(int, void *), void *context)
+{
+    TRACE_BEGIN();
+    TreeNode *current = root;
+    while (current != NULL)
+    {
+        if (current->left == NULL)
+        {
+            visit(current->data, context);
+            current = current->right;
+            continue;
+        }
+
+        TreeNode *predecessor = current->left;
+        while (predecessor->right != NULL && predecessor->right != current)
+        {
+            predecessor = predecessor->right;
+        }
+
+        if (predecessor->right == NULL)
+        {
+            predecessor->right = current; // Thread back, then go left
+            current = current->left;
+        }
+        else
+        {
+            predecessor->right = NULL; // Left side done: remove the thread
+            visit(current->data, context);
+            current = current->right;
+        }
+    }
+    TRACE_END("morrisInorderTraversal");
+}
+
+// Animated key printer shared by every printing traversal
+void printKeyAnimated(int key, void *context)
+{
+    (void)context;
+    printf("%d ", key);
+    fflush(stdout); // Added for animation effect
+    SLEEP(100);     // Added for animation effect
+}
+
+void inorderTraversal(TreeNode *root)
+{
+    treeWalk(root, TREE_ORDER_INORDER, printKeyAnimated, NULL);
+}
+
+void preorderTraversal(TreeNode *root)
+{
+    treeWalk(root, TREE_ORDER_PREORDER, printKeyAnimated, NULL);
+}
+
+void postorderTraversal(TreeNode *root)
+{
+    treeWalk(root, TREE_ORDER_POSTORDER, printKeyAnimated, NULL);
+}
+
+void levelorderTraversal(TreeNode *root)
+{
+    treeWalk(root, TREE_ORDER_LEVEL, printKeyAnimated, NULL);
+}
+
+// Every TreeNode lives in treeNodePool, so a whole tree is released slab by
+// slab instead of by walking it node by node
+void freeAllTreeNodes()
+{
+    poolDestroy(&treeNodePool);
+}
+
+// Releases every TreeNode but keeps the slabs, so a tree rebuilt right away
+// (snapshot load, bulk load, benchmark repetitions) skips malloc
+void resetAllTreeNodes()
+{
+    poolReset(&treeNodePool);
+}
+
+// Parallel Tree Functions-------------------------------------------------------------
+// parallelTreeReduce splits the tree lazily: a worker walks its task with a
+// private stack and hands the oldest entry of that stack (the largest
+// subtree it has not started) to its deque only when the deque has run dry
+// and it has walked TREE_PARALLEL_GRAIN nodes since it last shared. Thieves
+// therefore always find big subtrees, and every task is large enough to
+// repay its one CAS; small subtrees are never split at all
+
+// Cores the pool may use; Windows builds have no pthreads and use one
+int onlineCores()
+{
+#ifdef _WIN32
+    return 1;
+#else
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (int)cores : 1;
+#endif
+}
+
+// Runs body(args + i * argSize) for i = 0..threads-1, each on its own
+// thread (the calling thread takes i = 0), and returns once all are done
+void runWorkerThreads(int threads, void *(*body)(void *), void *args, size_t argSize)
+{
+#ifdef _WIN32
+    for (int i = 0; i < threads; i++)
+    {
+        body((char *)args + i * argSize); // No pthreads: one after another
+    }
+#else
+    pthread_t tids[TREE_PARALLEL_MAX_THREADS];
+    for (int i = 1; i < threads; i++)
+    {
+        pthread_create(&tids[i], NULL, body, (char *)args + i * argSize);
+    }
+    body(args);
+    for (int i = 1; i < threads; i++)
+    {
+        pthread_join(tids[i], NULL);
+    }
+#endif
+}
+
+// Owner only. Returns 0 if the deque is full
+int workPush(WorkDeque *deque, TreeNode *node)
+{
+    long long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    long long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (bottom - top >= WORK_DEQUE_CAPACITY)
+    {
+        return 0;
+    }
+    atomic_store_explicit(&deque->tasks[bottom & (WORK_DEQUE_CAPACITY - 1)], node, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    return 1;
+}
+
+// Owner only: takes the newest task, or returns NULL
+TreeNode *workPop(WorkDeque *deque)
+{
+    long long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed); // Was empty
+        return NULL;
+    }
+
+    TreeNode *node = atomic_load_explicit(&deque->tasks[bottom & (WORK_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (top == bottom)
+    {
+        // Last task: thieves may be after it too, so claim it the way they do
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                     memory_order_seq_cst, memory_order_relaxed))
+        {
+            node = NULL;
+        }
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return node;
+}
+
+// Any thread: takes the oldest task, or returns NULL if there is none or
+// another thread won it
+TreeNode *workSteal(WorkDeque *deque)
+{
+    long long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom)
+    {
+        return NULL;
+    }
+
+    TreeNode *node = atomic_load_explicit(&deque->tasks[top & (WORK_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed))
+    {
+        return NULL;
+    }
+    return node;
+}
+
+// Folds one task's subtree into the worker's partial
+void reduceSubtree(TreeWorker *worker, TreeNode *node)
+{
+    WorkPool *pool = worker->pool;
+    TreeReducer *reducer = pool->reducer;
+    WorkDeque *deque = &pool->deques[worker->id];
+    void *partial = pool->partials + worker->id * pool->stride;
+    long long base = 0, depth = 0, walked = 0;
+
+    worker->stack[depth++] = node;
+    while (depth > base)
+    {
+        node = worker->stack[--depth];
+        reducer->visit(partial, node->data, reducer->context);
+
+        if (depth + 2 > worker->capacity)
+        {
+            worker->capacity *= 2;
+            worker->stack = (TreeNode **)realloc(worker->stack, worker->capacity * sizeof(TreeNode *));
+            if (worker->stack == NULL)
+            {
+                fprintf(stderr, "Memory allocation failed!\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        if (node->right != NULL)
+        {
+            worker->stack[depth++] = node->right;
+        }
+        if (node->left != NULL)
+        {
+            worker->stack[depth++] = node->left;
+        }
+
+        if (pool->workers > 1 && ++walked >= TREE_PARALLEL_GRAIN && depth - base > 1 &&
+            atomic_load_explicit(&deque->bottom, memory_order_relaxed) <=
+                atomic_load_explicit(&deque->top, memory_order_relaxed))
+        {
+            // Counted before it is published, so pending cannot reach zero
+            // while the task is still waiting to be stolen
+            atomic_fetch_add_explicit(&pool->pending, 1, memory_order_relaxed);
+            if (workPush(deque, worker->stack[base]))
+            {
+                base++;
+            }
+            else
+            {
+                atomic_fetch_sub_explicit(&pool->pending, 1, memory_order_relaxed);
+            }
+            walked = 0;
+        }
+    }
+}
+
+// Worker loop: run its own tasks, else steal from a random other worker,
+// until no task is queued or running anywhere
+void *treeWorkerMain(void *argument)
+{
+    TreeWorker *worker = (TreeWorker *)argument;
+    WorkPool *pool = worker->pool;
+    int spins = 0;
+
+    while (atomic_load_explicit(&pool->pending, memory_order_acquire) > 0)
+    {
+        TreeNode *node = workPop(&pool->deques[worker->id]);
+        if (node == NULL && pool->workers > 1)
+        {
+            int victim = (int)(nextRandom(&worker->seed) % (pool->workers - 1));
+            node = workSteal(&pool->deques[victim + (victim >= worker->id)]); // Never itself
+        }
+        if (node == NULL)
+        {
+#ifndef _WIN32
+            backoffWait(&spins);
+#endif
+            continue;
+        }
+
+        spins = 0;
+        reduceSubtree(worker, node);
+        atomic_fetch_sub_explicit(&pool->pending, 1, memory_order_acq_rel);
+    }
+    (void)spins;
+    return NULL;
+}
+
+// Runs reducer over every key of the tree on `threads` workers (the calling
+// thread is one of them) and leaves the merged result in result, which
+// must hold partialSize bytes. One thread walks the tree sequentially, with
+// no stealing, which makes it the baseline for the speedup
+void parallelTreeReduce(TreeNode *root, int threads, TreeReducer *reducer, void *result)
+{
+#ifdef _WIN32
+    threads = 1;
+#endif
+    threads = threads < 1 ? 1 : threads > TREE_PARALLEL_MAX_THREADS ? TREE_PARALLEL_MAX_THREADS : threads;
+
+    // Deques and partials share one block, rounded so each starts on a
+    // cache line of its own (malloc alone only guarantees 16 bytes)
+    WorkPool pool;
+    pool.workers = threads;
+    pool.reducer = reducer;
+    pool.stride = (reducer->partialSize + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+    char *block = (char *)malloc(threads * (sizeof(WorkDeque) + pool.stride) + CACHE_LINE_SIZE);
+    TreeWorker *workers = (TreeWorker *)malloc(threads * sizeof(TreeWorker));
+    if (block == NULL || workers == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    pool.deques = (WorkDeque *)(((uintptr_t)block + CACHE_LINE_SIZE - 1) & ~(uintptr_t)(CACHE_LINE_SIZE - 1));
+    pool.partials = (char *)(pool.deques + threads);
+
+    for (int i = 0; i < threads; i++)
+    {
+        atomic_init(&pool.deques[i].top, 0);
+        atomic_init(&pool.deques[i].bottom, 0);
+        reducer->init(pool.partials + i * pool.stride, reducer->context);
+
+        workers[i].pool = &pool;
+        workers[i].id = i;
+        workers[i].capacity = 64;
+        workers[i].stack = (TreeNode **)malloc(workers[i].capacity * sizeof(TreeNode *));
+        workers[i].seed = 0x9E3779B97F4A7C15ull * (i + 1);
+        if (workers[i].stack == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    atomic_init(&pool.pending, root != NULL);
+    if (root != NULL)
+    {
+        workPush(&pool.deques[0], root);
+    }
+
+    runWorkerThreads(threads, treeWorkerMain, workers, sizeof(TreeWorker));
+
+    reducer->init(result, reducer->context);
+    for (int i = 0; i < threads; i++)
+    {
+        reducer->merge(result, pool.partials + i * pool.stride, reducer->context);
+        free(workers[i].stack);
+    }
+    free(workers);
+    free(block);
+}
+
+void summaryInit(void *partial, void *context)
+{
+    (void)context;
+    TreeSummary *summary = (TreeSummary *)partial;
+    summary->count = 0;
+    summary->sum = 0;
+    summary->min = INT_MAX;
+    summary->max = INT_MIN;
+}
+
+void summaryVisit(void *partial, int key, void *context)
+{
+    (void)context;
+    TreeSummary *summary = (TreeSummary *)partial;
+    summary->count++;
+    summary->sum += key;
+    summary->min = key < summary->min ? key : summary->min;
+    summary->max = key > summary->max ? key : summary->max;
+}
+
+void summaryMerge(void *into, void *from, void *context)
+{
+    (void)context;
+    TreeSummary *total = (TreeSummary *)into, *part = (TreeSummary *)from;
+    total->count += part->count;
+    total->sum += part->sum;
+    total->min = part->min < total->min ? part->min : total->min;
+    total->max = part->max > total->max ? part->max : total->max;
+}
+
+void treeHistogramInit(void *partial, void *context)
+{
+    memset(partial, 0, ((TreeHistogram *)context)->buckets * sizeof(long long));
+}
+
+// Keys outside [low, high] are not counted
+void treeHistogramVisit(void *partial, int key, void *context)
+{
+    TreeHistogram *histogram = (TreeHistogram *)context;
+    if (key >= histogram->low && key <= histogram->high)
+    {
+        long long span = (long long)histogram->high - histogram->low + 1;
+        ((long long *)partial)[((long long)key - histogram->low) * histogram->buckets / span]++;
+    }
+}
+
+void treeHistogramMerge(void *into, void *from, void *context)
+{
+    for (int i = 0; i < ((TreeHistogram *)context)->buckets; i++)
+    {
+        ((long long *)into)[i] += ((long long *)from)[i];
+    }
+}
+
+void filterInit(void *partial, void *context)
+{
+    (void)context;
+    KeyArray *array = (KeyArray *)partial;
+    array->keys = NULL;
+    array->count = array->capacity = 0;
+}
+
+void keyArrayAppend(KeyArray *array, const int *keys, long long count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    if (array->count + count > array->capacity)
+    {
+        while (array->count + count > array->capacity)
+        {
+            array->capacity = array->capacity > 0 ? array->capacity * 2 : 64;
+        }
+        array->keys = (int *)realloc(array->keys, array->capacity * sizeof(int));
+        if (array->keys == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memcpy(array->keys + array->count, keys, count * sizeof(int));
+    array->count += count;
+}
+
+void filterVisit(void *partial, int key, void *context)
+{
+    TreeFilter *filter = (TreeFilter *)context;
+    if (filter->keep(key, filter->context))
+    {
+        keyArrayAppend((KeyArray *)partial, &key, 1);
+    }
+}
+
+// Moves the worker's keys over and frees its array
+void filterMerge(void *into, void *from, void *context)
+{
+    (void)context;
+    KeyArray *part = (KeyArray *)from;
+    keyArrayAppend((KeyArray *)into, part->keys, part->count);
+    free(part->keys);
+}
+
+// Filter predicate: context points at an int[2] of inclusive bounds
+int keyInRange(int key, void *context)
+{
+    const int *bounds = (const int *)context;
+    return key >= bounds[0] && key <= bounds[1];
+}
+
+// B+ Tree Functions-------------------------------------------------------------------
+
+BPlusNode *createBPlusNode(int isLeaf)
+{
+    // Leaves carry a sibling link, inner nodes a child array
+    BPlusNode *node = (BPlusNode *)malloc(isLeaf ? sizeof(BPlusLeaf) : sizeof(BPlusInner));
+    if (node == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    STAT_ALLOC(STAT_TREE, isLeaf ? sizeof(BPlusLeaf) : sizeof(BPlusInner));
+    node->isLeaf = isLeaf;
+    node->count = 0;
+    if (isLeaf)
+    {
+        BPLUS_NEXT(node) = NULL;
+    }
+    return node;
+}
+
+// First position whose key is >= key
+int bplusLowerBound(const int *keys, int count, int key)
+{
+    int low = 0, high = count;
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (keys[middle] < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// First position whose key is > key: the child to follow in an inner node
+int bplusUpperBound(const int *keys, int count, int key)
+{
+    int low = 0, high = count;
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (keys[middle] <= key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+BPlusNode *bplusFindLeaf(BPlusTree *tree, int key)
+{
+    BPlusNode *node = tree->root;
+    while (node != NULL && !node->isLeaf)
+    {
+        node = BPLUS_CHILDREN(node)[bplusUpperBound(node->keys, node->count, key)];
+    }
+    return node;
+}
+
+int bplusSearch(BPlusTree *tree, int key)
+{
+    BPlusNode *leaf = bplusFindLeaf(tree, key);
+    if (leaf == NULL)
+    {
+        return 0;
+    }
+    int position = bplusLowerBound(leaf->keys, leaf->count, key);
+    return position < leaf->count && leaf->keys[position] == key;
+}
+
+// Inserts below node. Returns 1 when node had to split, handing the new
+// right sibling and its separator key back to the parent
+int bplusInsertInto(BPlusNode *node, int key, int *inserted, int *splitKey, BPlusNode **splitNode)
+{
+    if (node->isLeaf)
+    {
+        int position = bplusLowerBound(node->keys, node->count, key);
+        if (position < node->count && node->keys[position] == key)
+        {
+            return 0; // Duplicate
+        }
+        *inserted = 1;
+
+        if (node->count < BPLUS_ORDER)
+        {
+            memmove(&node->keys[position + 1], &node->keys[position], (node->count - position) * sizeof(int));
+            node->keys[position] = key;
+            node->count++;
+            return 0;
+        }
+
+        int all[BPLUS_ORDER + 1];
+        memcpy(all, node->keys, position * sizeof(int));
+        all[position] = key;
+        memcpy(&all[position + 1], &node->keys[position], (BPLUS_ORDER - position) * sizeof(int));
+
+        // Appending past the last key of the last leaf (sorted input) leaves
+        // the old leaf full instead of half empty; an underfull last leaf is
+        // repaired by the normal borrow/merge path if deletes reach it
+        BPlusNode *right = createBPlusNode(1);
+        int appending = position == BPLUS_ORDER && BPLUS_NEXT(node) == NULL;
+        int leftCount = appending ? BPLUS_ORDER : (BPLUS_ORDER + 1) / 2;
+        node->count = leftCount;
+        right->count = BPLUS_ORDER + 1 - leftCount;
+        memcpy(node->keys, all, leftCount * sizeof(int));
+        memcpy(right->keys, &all[leftCount], right->count * sizeof(int));
+        BPLUS_NEXT(right) = BPLUS_NEXT(node);
+        BPLUS_NEXT(node) = right;
+
+        *splitKey = right->keys[0];
+        *splitNode = right;
+        return 1;
+    }
+
+    int index = bplusUpperBound(node->keys, node->count, key);
+    int childKey;
+    BPlusNode *childSplit;
+    if (!bplusInsertInto(BPLUS_CHILDREN(node)[index], key, inserted, &childKey, &childSplit))
+    {
+        return 0;
+    }
+
+    if (node->count < BPLUS_ORDER)
+    {
+        memmove(&node->keys[index + 1], &node->keys[index], (node->count - index) * sizeof(int));
+        memmove(&BPLUS_CHILDREN(node)[index + 2], &BPLUS_CHILDREN(node)[index + 1], (node->count - index) * sizeof(BPlusNode *));
+        node->keys[index] = childKey;
+        BPLUS_CHILDREN(node)[index + 1] = childSplit;
+        node->count++;
+        return 0;
+    }
+
+    // Full inner node: split around the middle key, which moves up
+    int keys[BPLUS_ORDER + 1];
+    BPlusNode *children[BPLUS_ORDER + 2];
+    memcpy(keys, node->keys, index * sizeof(int));
+    keys[index] = childKey;
+    memcpy(&keys[index + 1], &node->keys[index], (BPLUS_ORDER - index) * sizeof(int));
+    memcpy(children, BPLUS_CHILDREN(node), (index + 1) * sizeof(BPlusNode *));
+    children[index + 1] = childSplit;
+    memcpy(&children[index + 2], &BPLUS_CHILDREN(node)[index + 1], (BPLUS_ORDER - index) * sizeof(BPlusNode *));
+
+    int middle = (BPLUS_ORDER + 1) / 2;
+    BPlusNode *right = createBPlusNode(0);
+    node->count = middle;
+    right->count = BPLUS_ORDER - middle;
+    memcpy(node->keys, keys, middle * sizeof(int));
+    memcpy(BPLUS_CHILDREN(node), children, (middle + 1) * sizeof(BPlusNode *));
+    memcpy(right->keys, &keys[middle + 1], right->count * sizeof(int));
+    memcpy(BPLUS_CHILDREN(right), &children[middle + 1], (right->count + 1) * sizeof(BPlusNode *));
+
+    *splitKey = keys[middle];
+    *splitNode = right;
+    return 1;
+}
+
+// Returns 1 if the key was new
+int bplusInsert(BPlusTree *tree, int key)
+{
+    if (tree->root == NULL)
+    {
+        tree->root = createBPlusNode(1);
+        tree->height = 1;
+    }
+
+    int inserted = 0, splitKey;
+    BPlusNode *splitNode;
+    if (bplusInsertInto(tree->root, key, &inserted, &splitKey, &splitNode))
+    {
+        BPlusNode *root = createBPlusNode(0);
+        root->count = 1;
+        root->keys[0] = splitKey;
+        BPLUS_CHILDREN(root)[0] = tree->root;
+        BPLUS_CHILDREN(root)[1] = splitNode;
+        tree->root = root;
+        tree->height++;
+    }
+    tree->size += inserted;
+    return inserted;
+}
+
+// Refills children[index] after a delete left it below half full, first by
+// borrowing from a sibling and otherwise by merging with one
+void bplusFixChild(BPlusNode *parent, int index)
+{
+    BPlusNode *child = BPLUS_CHILDREN(parent)[index];
+    BPlusNode *left = index > 0 ? BPLUS_CHILDREN(parent)[index - 1] : NULL;
+    BPlusNode *right = index < parent->count ? BPLUS_CHILDREN(parent)[index + 1] : NULL;
+
+    if (left != NULL && left->count > BPLUS_MIN_KEYS)
+    {
+        memmove(&child->keys[1], child->keys, child->count * sizeof(int));
+        if (child->isLeaf)
+        {
+            child->keys[0] = left->keys[left->count - 1];
+            parent->keys[index - 1] = child->keys[0];
+        }
+        else
+        {
+            memmove(&BPLUS_CHILDREN(child)[1], BPLUS_CHILDREN(child), (child->count + 1) * sizeof(BPlusNode *));
+            child->keys[0] = parent->keys[index - 1];
+            BPLUS_CHILDREN(child)[0] = BPLUS_CHILDREN(left)[left->count];
+            parent->keys[index - 1] = left->keys[left->count - 1];
+        }
+        left->count--;
+        child->count++;
+        return;
+    }
+
+    if (right != NULL && right->count > BPLUS_MIN_KEYS)
+    {
+        if (child->isLeaf)
+        {
+            child->keys[child->count] = right->keys[0];
+            memmove(right->keys, &right->keys[1], (right->count - 1) * sizeof(int));
+            parent->keys[index] = right->keys[0];
+        }
+        else
+        {
+            child->keys[child->count] = parent->keys[index];
+            BPLUS_CHILDREN(child)[child->count + 1] = BPLUS_CHILDREN(right)[0];
+            parent->keys[index] = right->keys[0];
+            memmove(right->keys, &right->keys[1], (right->count - 1) * sizeof(int));
+            memmove(BPLUS_CHILDREN(right), &BPLUS_CHILDREN(right)[1], right->count * sizeof(BPlusNode *));
+        }
+        right->count--;
+        child->count++;
+        return;
+    }
+
+    // Merge the right node of the pair into the left one
+    if (left == NULL)
+    {
+        left = child;
+        index++;
+    }
+    BPlusNode *merged = BPLUS_CHILDREN(parent)[index];
+
+    if (left->isLeaf)
+    {
+        memcpy(&left->keys[left->count], merged->keys, merged->count * sizeof(int));
+        left->count += merged->count;
+        BPLUS_NEXT(left) = BPLUS_NEXT(merged);
+    }
+    else
+    {
+        left->keys[left->count] = parent->keys[index - 1];
+        memcpy(&left->keys[left->count + 1], merged->keys, merged->count * sizeof(int));
+        memcpy(&BPLUS_CHILDREN(left)[left->count + 1], BPLUS_CHILDREN(merged), (merged->count + 1) * sizeof(BPlusNode *));
+        left->count += merged->count + 1;
+    }
+    free(merged);
+
+    memmove(&parent->keys[index - 1], &parent->keys[index], (parent->count - index) * sizeof(int));
+    memmove(&BPLUS_CHILDREN(parent)[index], &BPLUS_CHILDREN(parent)[index + 1], (parent->count - index) * sizeof(BPlusNode *));
+    parent->count--;
+}
+
+int bplusDeleteFrom(BPlusNode *node, int key)
+{
+    if (node->isLeaf)
+    {
+        int position = bplusLowerBound(node->keys, node->count, key);
+        if (position == node->count || node->keys[position] != key)
+        {
+            return 0;
+        }
+        memmove(&node->keys[position], &node->keys[position + 1], (node->count - position - 1) * sizeof(int));
+        node->count--;
+        return 1;
+    }
+
+    int index = bplusUpperBound(node->keys, node->count, key);
+    if (!bplusDeleteFrom(BPLUS_CHILDREN(node)[index], key))
+    {
+        return 0;
+    }
+    if (BPLUS_CHILDREN(node)[index]->count < BPLUS_MIN_KEYS)
+    {
+        bplusFixChild(node, index);
+    }
+    return 1;
+}
+
+// Returns 1 if the key was present
+int bplusDelete(BPlusTree *tree, int key)
+{
+    if (tree->root == NULL || !bplusDeleteFrom(tree->root, key))
+    {
+        return 0;
+    }
+    tree->size--;
+
+    // Collapse a root left with a single child (or an empty root leaf)
+    BPlusNode *root = tree->root;
+    if (!root->isLeaf && root->count == 0)
+    {
+        tree->root = BPLUS_CHILDREN(root)[0];
+        tree->height--;
+        free(root);
+    }
+    else if (root->isLeaf && root->count == 0)
+    {
+        tree->root = NULL;
+        tree->height = 0;
+        free(root);
+    }
+    return 1;
+}
+
+// Calls visit() for every key in [low, high] in ascending order by walking
+// the leaf chain; returns the number of keys visited
+long long bplusRangeScan(BPlusTree *tree, int low, int high, void (*visit)(int, void *), void *context)
+{
+    long long visited = 0;
+    BPlusNode *leaf = bplusFindLeaf(tree, low);
+    int position = leaf != NULL ? bplusLowerBound(leaf->keys, leaf->count, low) : 0;
+
+    while (leaf != NULL)
+    {
+        for (; position < leaf->count; position++)
+        {
+            if (leaf->keys[position] > high)
+            {
+                return visited;
+            }
+            visit(leaf->keys[position], context);
+            visited++;
+        }
+        leaf = BPLUS_NEXT(leaf);
+        position = 0;
+    }
+    return visited;
+}
+
+// All keys in ascending order; *count receives the number of keys
+int *bplusCollectKeys(BPlusTree *tree, long long *count)
+{
+    int *keys = (int *)malloc((tree->size > 0 ? tree->size : 1) * sizeof(int));
+    if (keys == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    long long size = 0;
+    BPlusNode *leaf = bplusFindLeaf(tree, INT_MIN);
+    for (; leaf != NULL; leaf = BPLUS_NEXT(leaf))
+    {
+        memcpy(&keys[size], leaf->keys, leaf->count * sizeof(int));
+        size += leaf->count;
+    }
+    *count = size;
+    return keys;
+}
+
+void freeBPlusNode(BPlusNode *node)
+{
+    if (node != NULL && !node->isLeaf)
+    {
+        for (int i = 0; i <= node->count; i++)
+        {
+            freeBPlusNode(BPLUS_CHILDREN(node)[i]);
+        }
+    }
+    free(node);
+}
+
+void freeBPlusTree(BPlusTree *tree)
+{
+    freeBPlusNode(tree->root);
+    tree->root = NULL;
+    tree->size = 0;
+    tree->height = 0;
+}
+
+// Sideways view like visualizeBinaryTree: one line per node, children indented
+void visualizeBPlusNode(BPlusNode *node, int space, int *rowsLeft)
+{
+    int budget = viewColumns() - space - 16;
+
+    (*rowsLeft)--;
+    framePrintf("\n");
+    for (int i = 0; i < space; i++)
+    {
+        framePrintf(" ");
+    }
+
+#ifdef _WIN32
+    frameColor(node->isLeaf ? GREEN : YELLOW);
+#else
+    frameColor(node->isLeaf ? GREEN : YELLOW);
+#endif
+
+    // Wide nodes are cut to the screen width
+    char key[16];
+    int i = 0;
+    framePrintf("[");
+    for (; i < node->count; i++)
+    {
+        int width = snprintf(key, sizeof(key), i == 0 ? "%d" : " %d", node->keys[i]);
+        if (width > budget)
+        {
+            framePrintf(" ... +%d", node->count - i);
+            break;
+        }
+        framePrintf("%s", key);
+        budget -= width;
+    }
+    framePrintf("]");
+
+#ifdef _WIN32
+    frameColor(RESET);
+#else
+    frameColor(RESET);
+#endif
+
+    if (!node->isLeaf)
+    {
+        for (int i = 0; i <= node->count; i++)
+        {
+            if (*rowsLeft <= 1)
+            {
+                // Out of rows: one line stands for the remaining siblings
+                framePrintf("\n");
+                for (int j = 0; j < space + 5; j++)
+                {
+                    framePrintf(" ");
+                }
+                framePrintf("... %d more nodes", node->count + 1 - i);
+                (*rowsLeft)--;
+                break;
+            }
+            visualizeBPlusNode(BPLUS_CHILDREN(node)[i], space + 5, rowsLeft);
+        }
+    }
+}
+
+void visualizeBPlusTree(BPlusTree *tree, int reservedRows)
+{
+    int rowsLeft = viewRows(reservedRows);
+    if (tree->root != NULL)
+    {
+        visualizeBPlusNode(tree->root, 0, &rowsLeft);
+    }
+}
+
+// Builds the balanced subtree over keys[low, high). Nodes come from the pool
+// in preorder, so each subtree's top levels share cache lines; recursion
+// depth is only log2(n)
+TreeNode *linkSortedKeys(const int *keys, long long low, long long high)
+{
+    if (low >= high)
+    {
+        return NULL;
+    }
+
+    long long middle = low + (high - low) / 2;
+    TreeNode *node = createTreeNode(keys[middle]);
+    node->left = linkSortedKeys(keys, low, middle);
+    node->right = linkSortedKeys(keys, middle + 1, high);
+    updateTreeHeight(node);
+    return node;
+}
+
+// Builds a perfectly balanced TreeNode tree from ascending, distinct keys in
+// O(n), with no temporary arrays
+TreeNode *buildTreeFromSorted(const int *keys, long long count)
+{
+    return linkSortedKeys(keys, 0, count);
+}
+
+// Bulk Load Functions------------------------------------------------------------------
+
+// Sorts ascending in place with an LSD radix sort: three passes of 11 bits
+// over the sign-flipped keys. Already-sorted input and passes whose digit is
+// the same for every key are skipped
+void radixSortKeys(int *keys, long long count)
+{
+    long long i;
+    for (i = 1; i < count && keys[i - 1] <= keys[i]; i++)
+    {
+    }
+    if (i >= count)
+    {
+        return;
+    }
+
+    unsigned int *source = (unsigned int *)keys;
+    unsigned int *target = (unsigned int *)malloc(count * sizeof(unsigned int));
+    long long *buckets = (long long *)malloc(2048 * sizeof(long long));
+    if (target == NULL || buckets == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int shift = 0; shift < 32; shift += 11)
+    {
+        memset(buckets, 0, 2048 * sizeof(long long));
+        for (i = 0; i < count; i++)
+        {
+            buckets[((source[i] ^ 0x80000000u) >> shift) & 2047]++;
+        }
+        if (buckets[((source[0] ^ 0x80000000u) >> shift) & 2047] == count)
+        {
+            continue; // Every key has this digit; the pass would not move anything
+        }
+
+        long long offset = 0;
+        for (int b = 0; b < 2048; b++)
+        {
+            long long size = buckets[b];
+            buckets[b] = offset;
+            offset += size;
+        }
+        for (i = 0; i < count; i++)
+        {
+            target[buckets[((source[i] ^ 0x80000000u) >> shift) & 2047]++] = source[i];
+        }
+
+        unsigned int *swap = source;
+        source = target;
+        target = swap;
+    }
+
+    if (source != (unsigned int *)keys)
+    {
+        memcpy(keys, source, count * sizeof(int));
+        target = source;
+    }
+    free(target);
+    free(buckets);
+}
+
+// Drops repeats from sorted keys in place; returns how many are left
+long long uniqueSortedKeys(int *keys, long long count)
+{
+    long long unique = 0;
+    for (long long i = 0; i < count; i++)
+    {
+        if (unique == 0 || keys[unique - 1] != keys[i])
+        {
+            keys[unique++] = keys[i];
+        }
+    }
+    return unique;
+}
+
+// Reads whitespace- or comma-separated integers (anything else separates
+// too, NUL bytes included) in 1 MB blocks. Returns a malloc'd array; *count
+// receives its size
+int *readKeys(FILE *input, long long *count)
+{
+    long long capacity = 1024, size = 0;
+    int *keys = (int *)malloc(capacity * sizeof(int));
+    char *block = (char *)malloc(1 << 20);
+    if (keys == NULL || block == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    long long value = 0;
+    int inNumber = 0, negative = 0;
+    size_t got;
+    do
+    {
+        got = fread(block, 1, 1 << 20, input);
+        for (size_t i = 0; i <= got; i++)
+        {
+            // The position past a short (final) read ends the last number;
+            // after a full block the number may continue in the next one
+            if (i == got && got == 1 << 20)
+            {
+                break;
+            }
+            char c = i < got ? block[i] : ' ';
+            if (c >= '0' && c <= '9')
+            {
+                if (value <= (long long)INT_MAX + 1)
+                {
+                    value = value * 10 + (c - '0');
+                }
+                inNumber = 1;
+            }
+            else if (c == '-' && !inNumber)
+            {
+                negative = 1;
+            }
+            else
+            {
+                if (inNumber)
+                {
+                    long long key = negative ? -value : value;
+                    if (size == capacity)
+                    {
+                        capacity *= 2;
+                        keys = (int *)realloc(keys, capacity * sizeof(int));
+                        if (keys == NULL)
+                        {
+                            fprintf(stderr, "Memory allocation failed!\n");
+                            exit(EXIT_FAILURE);
+                        }
+                    }
+                    keys[size++] = key < INT_MIN ? INT_MIN : key > INT_MAX ? INT_MAX : (int)key;
+                }
+                value = 0;
+                inNumber = 0;
+                negative = 0;
+            }
+        }
+    } while (got == 1 << 20);
+
+    free(block);
+    *count = size;
+    return keys;
+}
+
+// Adds keys[0..count) to the tree in O(n) plus the sort: existing keys are
+// merged in, everything is radix-sorted and deduplicated, and the tree is
+// rebuilt perfectly balanced (valid in every engine, including AVL). keys
+// is used as scratch space. Returns the number of distinct keys stored
+long long bulkLoadTree(TreeNode **root, BPlusTree *bplus, int *keys, long long count)
+{
+    long long existing = 0;
+    int *all = keys;
+
+    if (treeMode == TREE_MODE_BPLUS)
+    {
+        int *old = bplusCollectKeys(bplus, &existing);
+        if (existing > 0)
+        {
+            all = (int *)malloc((existing + count) * sizeof(int));
+            if (all == NULL)
+            {
+                fprintf(stderr, "Memory allocation failed!\n");
+                exit(EXIT_FAILURE);
+            }
+            memcpy(all, old, existing * sizeof(int));
+            memcpy(all + existing, keys, count * sizeof(int));
+        }
+        free(old);
+    }
+    else if (*root != NULL)
+    {
+        TreeNode **nodes = collectTreeNodes(*root, &existing);
+        all = (int *)malloc((existing + count) * sizeof(int));
+        if (all == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+        for (long long i = 0; i < existing; i++)
+        {
+            all[i] = nodes[i]->data;
+        }
+        memcpy(all + existing, keys, count * sizeof(int));
+        free(nodes);
+    }
+
+    count += existing;
+    radixSortKeys(all, count);
+    count = uniqueSortedKeys(all, count);
+
+    if (treeMode == TREE_MODE_BPLUS)
+    {
+        freeBPlusTree(bplus);
+        for (long long i = 0; i < count; i++)
+        {
+            bplusInsert(bplus, all[i]); // Ascending keys fill each leaf before splitting
+        }
+    }
+    else
+    {
+        resetAllTreeNodes();
+        *root = buildTreeFromSorted(all, count);
+    }
+
+    if (all != keys)
+    {
+        free(all);
+    }
+    return count;
+}
+
+// Bulk loads the integers in the file at path ('-' reads stdin). Returns the
+// number of distinct keys now in the tree, or -1 if the file cannot be
+// opened; *read receives how many integers were parsed
+long long bulkLoadFile(const char *path, TreeNode **root, BPlusTree *bplus, long long *read)
+{
+    FILE *input = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (input == NULL)
+    {
+        return -1;
+    }
+
+    int *keys = readKeys(input, read);
+    if (input != stdin)
+    {
+        fclose(input);
+    }
+
+    long long distinct = bulkLoadTree(root, bplus, keys, *read);
+    free(keys);
+    return distinct;
+}
+
+// Slot whose interval holds key, or count if key sits on a top-level node
+int findTreeSlot(const TreeSlot *slots, int count, int key)
+{
+    int low = 0, high = count - 1;
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (slots[middle].high < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return slots[low].high == key ? count : low;
+}
+
+void *insertWorkerMain(void *argument)
+{
+    InsertWorker *worker = (InsertWorker *)argument;
+
+    if (worker->phase == TREE_INSERT_COUNT)
+    {
+        for (long long i = worker->begin; i < worker->end; i++)
+        {
+            int slot = findTreeSlot(worker->slots, worker->slotCount, worker->keys[i]);
+            worker->slotOf[i] = (unsigned short)slot;
+            worker->offsets[slot]++;
+        }
+    }
+    else if (worker->phase == TREE_INSERT_SCATTER)
+    {
+        for (long long i = worker->begin; i < worker->end; i++)
+        {
+            int slot = worker->slotOf[i];
+            if (slot < worker->slotCount)
+            {
+                worker->partitioned[worker->offsets[slot]++] = worker->keys[i];
+            }
+        }
+    }
+    else
+    {
+        // Counted apart from whatever this thread already had, for the
+        // caller to merge (on Windows the caller runs this body itself)
+        DsStats saved = dsStats;
+        memset(&dsStats, 0, sizeof(DsStats));
+        threadTreePool = &worker->pool;
+        int slot;
+        while ((slot = atomic_fetch_add_explicit(worker->nextSlot, 1, memory_order_relaxed)) < worker->slotCount)
+        {
+            TreeNode **link = worker->slots[slot].link;
+            for (long long i = worker->slotStart[slot]; i < worker->slotStart[slot + 1]; i++)
+            {
+                *link = insertTreeNode(*link, worker->partitioned[i]);
+            }
+        }
+        threadTreePool = NULL;
+        worker->stats = dsStats;
+        dsStats = saved;
+    }
+    return NULL;
+}
+
+// Inserts count keys on `threads` workers and returns the new root. The top
+// levels of the tree are cut into up to TREE_INSERT_SLOTS_PER_THREAD slots
+// per thread (an empty tree first gets a balanced skeleton of splitters
+// sampled from the keys). The keys are counted and scattered by slot in
+// parallel, then workers claim slots and insert into them, each from its own
+// node pool. In AVL mode the top-level heights are then recomputed, and the
+// whole tree is rebalanced in O(n) only if the slots grew unevenly enough to
+// break the AVL property up there. Small batches insert sequentially; one
+// thread still partitions a large batch, so a thread-count sweep compares
+// the same algorithm throughout
+TreeNode *parallelInsertTree(TreeNode *root, const int *keys, long long count, int threads)
+{
+    threads = threads < 1 ? 1 : threads > TREE_PARALLEL_MAX_THREADS ? TREE_PARALLEL_MAX_THREADS : threads;
+    if (count < threads * (long long)TREE_INSERT_MIN_KEYS)
+    {
+        for (long long i = 0; i < count; i++)
+        {
+            root = insertTreeNode(root, keys[i]);
+        }
+        return root;
+    }
+
+    int target = threads * TREE_INSERT_SLOTS_PER_THREAD;
+    if (root == NULL)
+    {
+        // Every eighth key of a sorted sample of 8 * target becomes a splitter
+        long long sampleSize = (long long)target * 8;
+        int *sample = (int *)malloc(sampleSize * sizeof(int));
+        if (sample == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+        for (long long i = 0; i < sampleSize; i++)
+        {
+            sample[i] = keys[i * (count / sampleSize)];
+        }
+        radixSortKeys(sample, sampleSize);
+        long long unique = uniqueSortedKeys(sample, sampleSize), splitters = 0;
+        for (long long i = 4; i < unique; i += 8)
+        {
+            sample[splitters++] = sample[i];
+        }
+        root = buildTreeFromSorted(sample, splitters);
+        free(sample);
+    }
+
+    // Expand the top of the tree level by level. A slot is replaced in place
+    // by its node's two child slots, so the slots stay in key order
+    TreeSlot *slots = (TreeSlot *)malloc(target * sizeof(TreeSlot));
+    TreeSlot *level = (TreeSlot *)malloc(target * sizeof(TreeSlot));
+    TreeNode **tops = (TreeNode **)malloc(target * sizeof(TreeNode *));
+    if (slots == NULL || level == NULL || tops == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    int slotCount = 1, topCount = 0, expanded = 1;
+    slots[0].link = &root;
+    slots[0].low = (long long)INT_MIN - 1;
+    slots[0].high = (long long)INT_MAX + 1;
+
+    while (expanded && slotCount < target)
+    {
+        int next = 0;
+        expanded = 0;
+        for (int i = 0; i < slotCount; i++)
+        {
+            TreeNode *node = *slots[i].link;
+            if (node != NULL && next + slotCount - i < target)
+            {
+                tops[topCount++] = node;
+                level[next].link = &node->left;
+                level[next].low = slots[i].low;
+                level[next++].high = node->data;
+                level[next].link = &node->right;
+                level[next].low = node->data;
+                level[next++].high = slots[i].high;
+                expanded = 1;
+            }
+            else
+            {
+                level[next++] = slots[i];
+            }
+        }
+        TreeSlot *swap = slots;
+        slots = level;
+        level = swap;
+        slotCount = next;
+    }
+
+    InsertWorker *workers = (InsertWorker *)malloc(threads * sizeof(InsertWorker));
+    long long *offsets = (long long *)calloc((long long)threads * (slotCount + 1), sizeof(long long));
+    long long *slotStart = (long long *)malloc((slotCount + 1) * sizeof(long long));
+    unsigned short *slotOf = (unsigned short *)malloc(count * sizeof(unsigned short));
+    int *partitioned = (int *)malloc(count * sizeof(int));
+    if (workers == NULL || offsets == NULL || slotStart == NULL || slotOf == NULL || partitioned == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    atomic_int nextSlot;
+    atomic_init(&nextSlot, 0);
+
+    for (int w = 0; w < threads; w++)
+    {
+        NodePool pool = POOL_INIT(TreeNode);
+        workers[w].phase = TREE_INSERT_COUNT;
+        workers[w].keys = keys;
+        workers[w].begin = count * w / threads;
+        workers[w].end = count * (w + 1) / threads;
+        workers[w].offsets = offsets + (long long)w * (slotCount + 1);
+        workers[w].slots = slots;
+        workers[w].slotCount = slotCount;
+        workers[w].slotOf = slotOf;
+        workers[w].partitioned = partitioned;
+        workers[w].slotStart = slotStart;
+        workers[w].nextSlot = &nextSlot;
+        workers[w].pool = pool;
+    }
+    runWorkerThreads(threads, insertWorkerMain, workers, sizeof(InsertWorker));
+
+    // Turn the per-worker counts into scatter positions: slot by slot, each
+    // worker's keys follow those of the workers before it
+    long long position = 0;
+    for (int slot = 0; slot < slotCount; slot++)
+    {
+        slotStart[slot] = position;
+        for (int w = 0; w < threads; w++)
+        {
+            long long size = workers[w].offsets[slot];
+            workers[w].offsets[slot] = position;
+            position += size;
+        }
+    }
+    slotStart[slotCount] = position;
+
+    for (int w = 0; w < threads; w++)
+    {
+        workers[w].phase = TREE_INSERT_SCATTER;
+    }
+    runWorkerThreads(threads, insertWorkerMain, workers, sizeof(InsertWorker));
+    for (int w = 0; w < threads; w++)
+    {
+        workers[w].phase = TREE_INSERT_BUILD;
+    }
+    runWorkerThreads(threads, insertWorkerMain, workers, sizeof(InsertWorker));
+
+    for (int w = 0; w < threads; w++)
+    {
+        poolAdopt(&treeNodePool, &workers[w].pool);
+        statsMerge(&dsStats, &workers[w].stats);
+    }
+
+    if (treeMode == TREE_MODE_AVL)
+    {
+        // tops is in level order, so walking it backwards sees children first
+        int balanced = 1;
+        for (int i = topCount - 1; i >= 0; i--)
+        {
+            updateTreeHeight(tops[i]);
+            int balance = treeHeight(tops[i]->left) - treeHeight(tops[i]->right);
+            balanced = balanced && balance >= -1 && balance <= 1;
+        }
+        if (!balanced)
+        {
+            root = rebalanceTree(root);
+        }
+    }
+
+    free(slots);
+    free(level);
+    free(tops);
+    free(workers);
+    free(offsets);
+    free(slotStart);
+    free(slotOf);
+    free(partitioned);
+    return root;
+}
+
+// Switches the tree engine, moving the keys across when the representation
+// changes. Entering AVL mode rebalances, because plain BST inserts leave
+// heights stale
+TreeNode *setTreeMode(TreeNode *root, BPlusTree *bplus, int mode)
+{
+    if (mode == TREE_MODE_BPLUS && treeMode != TREE_MODE_BPLUS)
+    {
+        long long count;
+        TreeNode **nodes = collectTreeNodes(root, &count);
+        for (long long i = 0; i < count; i++)
+        {
+            bplusInsert(bplus, nodes[i]->data);
+        }
+        free(nodes);
+        freeAllTreeNodes();
+        root = NULL;
+    }
+    else if (mode != TREE_MODE_BPLUS && treeMode == TREE_MODE_BPLUS)
+    {
+        long long count;
+        int *keys = bplusCollectKeys(bplus, &count);
+        root = buildTreeFromSorted(keys, count);
+        free(keys);
+        freeBPlusTree(bplus);
+    }
+    else if (mode == TREE_MODE_AVL && treeMode != TREE_MODE_AVL)
+    {
+        root = rebalanceTree(root);
+    }
+    treeMode = mode;
+    return root;
+}
+
+// Snapshot Functions-------------------------------------------------------------------
+// A snapshot is a 64-byte header followed by the keys as native 32-bit ints:
+// list head to tail, stack bottom to top, queue front to rear, a BST/AVL
+// tree in preorder (which fixes its exact shape) and a B+ tree ascending.
+// The payload starts 64 bytes in, so a mapped Stack/Queue array is aligned
+#define SNAPSHOT_MAGIC "DSSNAP\r\n" // The \r\n catches text-mode transfers
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_LIST 1
+#define SNAPSHOT_STACK 2
+#define SNAPSHOT_QUEUE 3
+#define SNAPSHOT_TREE 4
+#define SNAPSHOT_CHUNK 16384 // Ints buffered per write while saving
+
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t kind;      // SNAPSHOT_*
+    uint64_t count;     // Keys in the payload
+    uint64_t checksum;  // snapshotChecksum of the payload
+    int32_t treeMode;   // Engine a SNAPSHOT_TREE was saved from
+    uint32_t keySize;   // sizeof(int) of the writer
+    uint8_t reserved[24];
+} SnapshotHeader;
+
+typedef struct
+{
+    FILE *file;
+    int buffer[SNAPSHOT_CHUNK];
+    int used;
+    uint64_t count;
+    uint64_t checksum;
+} SnapshotWriter;
+
+typedef struct
+{
+    SnapshotHeader header;
+    const int *keys; // The payload, inside base
+    void *base;      // Mapped (or, on Windows, read) file
+    size_t length;
+} Snapshot;
+
+// FNV-1a over 64-bit words (a zero-padded word for any tail), which runs at
+// memory speed. Chained calls match one call when every chunk but the last
+// is a multiple of 8 bytes
+uint64_t snapshotChecksum(uint64_t hash, const void *data, size_t bytes)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    uint64_t word;
+    for (; bytes >= 8; bytes -= 8, p += 8)
+    {
+        memcpy(&word, p, 8);
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    if (bytes > 0)
+    {
+        word = 0;
+        memcpy(&word, p, bytes);
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Opens the file and reserves the header, which is written last
+int snapshotBegin(SnapshotWriter *writer, const char *path)
+{
+    SnapshotHeader blank = {{0}, 0, 0, 0, 0, 0, 0, {0}};
+    writer->file = fopen(path, "wb");
+    writer->used = 0;
+    writer->count = 0;
+    writer->checksum = 14695981039346656037ull;
+    return writer->file != NULL && fwrite(&blank, sizeof(blank), 1, writer->file) == 1;
+}
+
+void snapshotFlushChunk(SnapshotWriter *writer)
+{
+    writer->checksum = snapshotChecksum(writer->checksum, writer->buffer, writer->used * sizeof(int));
+    fwrite(writer->buffer, sizeof(int), writer->used, writer->file);
+    writer->used = 0;
+}
+
+void snapshotPut(SnapshotWriter *writer, int key)
+{
+    writer->buffer[writer->used++] = key;
+    writer->count++;
+    if (writer->used == SNAPSHOT_CHUNK)
+    {
+        snapshotFlushChunk(writer);
+    }
+}
+
+// Callback form of snapshotPut for the tree walkers
+void snapshotVisit(int key, void *context)
+{
+    snapshotPut((SnapshotWriter *)context, key);
+}
+
+int snapshotEnd(SnapshotWriter *writer, uint32_t kind, int mode)
+{
+    SnapshotHeader header = {{0}, 0, 0, 0, 0, 0, 0, {0}};
+    memcpy(header.magic, SNAPSHOT_MAGIC, 8);
+    header.version = SNAPSHOT_VERSION;
+    header.kind = kind;
+    header.treeMode = mode;
+    header.keySize = sizeof(int);
+
+    snapshotFlushChunk(writer);
+    header.count = writer->count;
+    header.checksum = writer->checksum;
+
+    int ok = !ferror(writer->file) && fseek(writer->file, 0, SEEK_SET) == 0 &&
+             fwrite(&header, sizeof(header), 1, writer->file) == 1;
+    return fclose(writer->file) == 0 && ok;
+}
+
+// Saves whichever list engine is active; both store the values in order
+int saveListSnapshot(LinkedList *list, UnrolledList *unrolled, const char *path)
+{
+    SnapshotWriter *writer = (SnapshotWriter *)malloc(sizeof(SnapshotWriter));
+    if (writer == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int ok = snapshotBegin(writer, path);
+    if (ok)
+    {
+        for (Node *current = list->head; current != NULL; current = current->next)
+        {
+            snapshotPut(writer, current->data);
+        }
+        for (ListChunk *chunk = unrolled->head; chunk != NULL; chunk = chunk->next)
+        {
+            for (int i = 0; i < chunk->count; i++)
+            {
+                snapshotPut(writer, chunk->values[i]);
+            }
+        }
+        ok = snapshotEnd(writer, SNAPSHOT_LIST, 0);
+    }
+    else if (writer->file != NULL)
+    {
+        fclose(writer->file);
+    }
+    free(writer);
+    return ok;
+}
+
+// Stack and queue arrays are already contiguous, so they are written whole
+int saveArraySnapshot(const int *first, int firstCount, const int *second, int secondCount,
+                      uint32_t kind, const char *path)
+{
+    SnapshotWriter *writer = (SnapshotWriter *)malloc(sizeof(SnapshotWriter));
+    if (writer == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int ok = snapshotBegin(writer, path);
+    if (ok)
+    {
+        // The checksum hashes 8-byte words, so a chained call must start on
+        // a word boundary: the even part of the first run is hashed and
+        // written in place, and an odd last key goes through the buffer
+        // with the second run, whose chunks are even too
+        int direct = firstCount & ~1;
+        writer->checksum = snapshotChecksum(writer->checksum, first, direct * sizeof(int));
+        fwrite(first, sizeof(int), direct, writer->file);
+        writer->count = direct;
+        if (direct < firstCount)
+        {
+            snapshotPut(writer, first[direct]);
+        }
+        for (int i = 0; i < secondCount; i++)
+        {
+            snapshotPut(writer, second[i]);
+        }
+        ok = snapshotEnd(writer, kind, 0);
+    }
+    else if (writer->file != NULL)
+    {
+        fclose(writer->file);
+    }
+    free(writer);
+    return ok;
+}
+
+int saveStackSnapshot(Stack *stack, const char *path)
+{
+    return saveArraySnapshot(stack->array, stackSize(stack), NULL, 0, SNAPSHOT_STACK, path);
+}
+
+int saveQueueSnapshot(Queue *queue, const char *path)
+{
+    int size = queueSize(queue);
+    if (size == 0)
+    {
+        return saveArraySnapshot(queue->array, 0, NULL, 0, SNAPSHOT_QUEUE, path);
+    }
+
+    // A wrapped ring goes out as its two runs, front part first
+    int firstPart = queue->capacity - queue->front;
+    if (firstPart > size)
+    {
+        firstPart = size;
+    }
+    return saveArraySnapshot(&queue->array[queue->front], firstPart, queue->array, size - firstPart,
+                             SNAPSHOT_QUEUE, path);
+}
+
+int saveTreeSnapshot(TreeNode *root, BPlusTree *bplus, const char *path)
+{
+    SnapshotWriter *writer = (SnapshotWriter *)malloc(sizeof(SnapshotWriter));
+    if (writer == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int ok = snapshotBegin(writer, path);
+    if (ok)
+    {
+        if (treeMode == TREE_MODE_BPLUS)
+        {
+            bplusRangeScan(bplus, INT_MIN, INT_MAX, snapshotVisit, writer);
+        }
+        else
+        {
+            treeWalk(root, TREE_ORDER_PREORDER, snapshotVisit, writer);
+        }
+        ok = snapshotEnd(writer, SNAPSHOT_TREE, treeMode);
+    }
+    else if (writer->file != NULL)
+    {
+        fclose(writer->file);
+    }
+    free(writer);
+    return ok;
+}
+
+void unmapSnapshot(void *base, size_t length)
+{
+#ifdef _WIN32
+    (void)length;
+    free(base);
+#else
+    munmap(base, length);
+#endif
+}
+
+// Maps a snapshot and checks its header and checksum. The mapping is
+// private and writable, so a Stack/Queue can use the payload as its array
+// directly; writes are copy-on-write and never reach the file. Windows has
+// no mmap here and reads the file into memory instead
+int openSnapshot(Snapshot *snapshot, const char *path, uint32_t kind)
+{
+    snapshot->base = NULL;
+    snapshot->length = 0;
+
+#ifdef _WIN32
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < (long)sizeof(SnapshotHeader))
+    {
+        fclose(file);
+        return 0;
+    }
+    snapshot->base = malloc(size);
+    if (snapshot->base == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    snapshot->length = size;
+    int complete = fread(snapshot->base, 1, size, file) == (size_t)size;
+    fclose(file);
+    if (!complete)
+    {
+        free(snapshot->base);
+        return 0;
+    }
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return 0;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(SnapshotHeader))
+    {
+        close(fd);
+        return 0;
+    }
+    snapshot->length = info.st_size;
+    snapshot->base = mmap(NULL, snapshot->length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (snapshot->base == MAP_FAILED)
+    {
+        return 0;
+    }
+#endif
+
+    memcpy(&snapshot->header, snapshot->base, sizeof(SnapshotHeader));
+    snapshot->keys = (const int *)((char *)snapshot->base + sizeof(SnapshotHeader));
+    SnapshotHeader *header = &snapshot->header;
+    uint64_t payload = snapshot->length - sizeof(SnapshotHeader);
+
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, 8) != 0 || header->version != SNAPSHOT_VERSION ||
+        header->kind != kind || header->keySize != sizeof(int) || header->count != payload / sizeof(int) ||
+        payload % sizeof(int) != 0 ||
+        snapshotChecksum(14695981039346656037ull, snapshot->keys, payload) != header->checksum)
+    {
+        unmapSnapshot(snapshot->base, snapshot->length);
+        return 0;
+    }
+#ifndef _WIN32
+    // Keys are read once, front to back
+    madvise(snapshot->base, snapshot->length, MADV_SEQUENTIAL);
+#endif
+    return 1;
+}
+
+// Loads into whichever list engine is active
+int loadListSnapshot(LinkedList *list, UnrolledList *unrolled, const char *path)
+{
+    Snapshot snapshot;
+    if (!openSnapshot(&snapshot, path, SNAPSHOT_LIST))
+    {
+        return 0;
+    }
+
+    resetAllListNodes();
+    resetAllListChunks();
+    list->head = list->tail = NULL;
+    list->length = 0;
+    unrolled->head = unrolled->tail = NULL;
+    unrolled->length = unrolled->chunks = 0;
+    for (uint64_t i = 0; i < snapshot.header.count; i++)
+    {
+        if (listMode == LIST_MODE_UNROLLED)
+        {
+            unrolledInsert(unrolled, snapshot.keys[i]);
+        }
+        else
+        {
+            insertNode(list, snapshot.keys[i]);
+        }
+    }
+    unmapSnapshot(snapshot.base, snapshot.length);
+    return 1;
+}
+
+// Zero-copy: the stack array points into the mapped payload
+Stack *loadStackSnapshot(const char *path)
+{
+    Snapshot snapshot;
+    if (!openSnapshot(&snapshot, path, SNAPSHOT_STACK))
+    {
+        return NULL;
+    }
+    if (snapshot.header.count == 0 || snapshot.header.count > INT_MAX / 2)
+    {
+        unmapSnapshot(snapshot.base, snapshot.length);
+        return snapshot.header.count == 0 ? createStack(16) : NULL;
+    }
+
+    Stack *stack = (Stack *)malloc(sizeof(Stack));
+    if (stack == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    stack->array = (int *)snapshot.keys;
+    stack->top = (int)snapshot.header.count - 1;
+    stack->capacity = (int)snapshot.header.count;
+    stack->minCapacity = 16;
+    stack->autoShrink = 0;
+    stack->mapping = snapshot.base;
+    stack->mappingLength = snapshot.length;
+    return stack;
+}
+
+// Zero-copy: the queue ring starts unwrapped inside the mapped payload
+Queue *loadQueueSnapshot(const char *path)
+{
+    Snapshot snapshot;
+    if (!openSnapshot(&snapshot, path, SNAPSHOT_QUEUE))
+    {
+        return NULL;
+    }
+    if (snapshot.header.count == 0 || snapshot.header.count > INT_MAX / 2)
+    {
+        unmapSnapshot(snapshot.base, snapshot.length);
+        return snapshot.header.count == 0 ? createQueue(16) : NULL;
+    }
+
+    Queue *queue = (Queue *)malloc(sizeof(Queue));
+    if (queue == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    queue->array = (int *)snapshot.keys;
+    queue->front = 0;
+    queue->rear = (int)snapshot.header.count - 1;
+    queue->capacity = (int)snapshot.header.count;
+    queue->minCapacity = 16;
+    queue->autoShrink = 0;
+    queue->mapping = snapshot.base;
+    queue->mappingLength = snapshot.length;
+    return queue;
+}
+
+// Checks that keys are the preorder of a BST before anything is rebuilt from
+// them: the checksum only catches damage, not a payload that was never a
+// tree. Walks the keys the way buildTreeFromPreorder places them, keeping
+// each open node's lower bound; a repeated key, or one that has no parent
+// or falls outside its bounds, fails. A B+ snapshot must be strictly
+// ascending instead
+int isSnapshotTreeOrder(const int *keys, long long count, int mode)
+{
+    if (mode == TREE_MODE_BPLUS)
+    {
+        for (long long i = 1; i < count; i++)
+        {
+            if (keys[i] <= keys[i - 1])
+            {
+                return 0;
+            }
+        }
+        return 1;
+    }
+    if (count == 0)
+    {
+        return 1;
+    }
+
+    int *open = (int *)malloc(count * sizeof(int));
+    long long *lower = (long long *)malloc(count * sizeof(long long));
+    if (open == NULL || lower == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    long long depth = 0, checked = 1;
+    open[0] = keys[0];
+    lower[depth++] = LLONG_MIN;
+    for (; checked < count; checked++)
+    {
+        int key = keys[checked];
+        long long bound;
+        if (key < open[depth - 1])
+        {
+            bound = lower[depth - 1];
+            if (key <= bound)
+            {
+                break;
+            }
+        }
+        else
+        {
+            long long before = depth;
+            while (depth > 0 && key > open[depth - 1])
+            {
+                depth--;
+            }
+            if (depth == before || (depth > 0 && key == open[depth - 1]))
+            {
+                break;
+            }
+            bound = open[depth]; // The last node popped becomes the parent
+        }
+        open[depth] = key;
+        lower[depth++] = bound;
+    }
+
+    free(open);
+    free(lower);
+    return checked == count;
+}
+
+// Rebuilds the exact tree from its preorder keys in O(n): each key hangs
+// left of the previous one if smaller, otherwise right of the deepest open
+// ancestor it exceeds. Heights are then filled in reverse preorder, which
+// reaches every child before its parent. The keys must have passed
+// isSnapshotTreeOrder
+TreeNode *buildTreeFromPreorder(const int *keys, long long count)
+{
+    if (count == 0)
+    {
+        return NULL;
+    }
+
+    TreeNode **order = (TreeNode **)malloc(count * sizeof(TreeNode *));
+    TreeNode **open = (TreeNode **)malloc(count * sizeof(TreeNode *));
+    if (order == NULL || open == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    long long depth = 0;
+    TreeNode *root = createTreeNode(keys[0]);
+    order[0] = open[depth++] = root;
+    for (long long i = 1; i < count; i++)
+    {
+        TreeNode *node = createTreeNode(keys[i]);
+        if (keys[i] < open[depth - 1]->data)
+        {
+            open[depth - 1]->left = node;
+        }
+        else
+        {
+            TreeNode *parent = NULL;
+            while (depth > 0 && keys[i] > open[depth - 1]->data)
+            {
+                parent = open[--depth];
+            }
+            parent->right = node;
+        }
+        order[i] = open[depth++] = node;
+    }
+
+    for (long long i = count - 1; i >= 0; i--)
+    {
+        updateTreeHeight(order[i]);
+    }
+    free(order);
+    free(open);
+    return root;
+}
+
+// Replaces the current tree with the snapshot, in the engine it was saved
+// from. Every check runs first, so a rejected file leaves the tree and the
+// engine as they were
+int loadTreeSnapshot(const char *path, TreeNode **root, BPlusTree *bplus)
+{
+    Snapshot snapshot;
+    if (!openSnapshot(&snapshot, path, SNAPSHOT_TREE))
+    {
+        return 0;
+    }
+    if (snapshot.header.treeMode < TREE_MODE_BST || snapshot.header.treeMode > TREE_MODE_BPLUS ||
+        !isSnapshotTreeOrder(snapshot.keys, snapshot.header.count, snapshot.header.treeMode))
+    {
+        unmapSnapshot(snapshot.base, snapshot.length);
+        return 0;
+    }
+
+    resetAllTreeNodes();
+    freeBPlusTree(bplus);
+    *root = NULL;
+    treeMode = snapshot.header.treeMode;
+    if (treeMode == TREE_MODE_BPLUS)
+    {
+        // Ascending keys append to the last leaf, which splits full
+        for (uint64_t i = 0; i < snapshot.header.count; i++)
+        {
+            bplusInsert(bplus, snapshot.keys[i]);
+        }
+    }
+    else
+    {
+        *root = buildTreeFromPreorder(snapshot.keys, snapshot.header.count);
+    }
+    unmapSnapshot(snapshot.base, snapshot.length);
+    return 1;
+}
+
+// Reads a file name for the snapshot menu entries; returns 0 on bad input
+int readFilePath(const char *prompt, char *path)
+{
+    printf("%s", prompt);
+    if (scanf("%255s", path) != 1)
+    {
+        while (getchar() != '\n')
+            ;
+        return 0;
+    }
+    return 1;
+}
+
+// Green or red one-line result for the snapshot menu entries
+void reportSnapshot(int ok, int saving, const char *path)
+{
+#ifdef _WIN32
+    setColor(ok ? GREEN : RED);
+#else
+    setColor(ok ? GREEN : RED);
+#endif
+
+    if (ok)
+    {
+        printf("\t\tSnapshot %s '%s'!\n", saving ? "saved to" : "loaded from", path);
+    }
+    else if (saving)
+    {
+        printf("\t\tCould not write snapshot '%s'!\n", path);
+    }
+    else
+    {
+        printf("\t\tCould not load '%s' (missing, wrong structure or corrupt)!\n", path);
+    }
+
+#ifdef _WIN32
+    setColor(RESET);
+#else
+    setColor(RESET);
+#endif
+
+    SLEEP(1000);
+}
+
+void bplusTraversal(BPlusTree *tree)
+{
+    bplusRangeScan(tree, INT_MIN, INT_MAX, printKeyAnimated, NULL);
+}
+
+void printBPlusNodeKeys(BPlusNode *node)
+{
+    printf("[");
+    for (int i = 0; i < node->count; i++)
+    {
+        printf(i > 0 ? " %d" : "%d", node->keys[i]);
+    }
+    printf("] ");
+    fflush(stdout); // Added for animation effect
+    SLEEP(100);     // Added for animation effect
+}
+
+// Preorder or postorder over whole nodes, each printed as its bracketed key
+// group: preorder shows an inner node's separators before the nodes below
+// it, postorder after them. Recursion is only as deep as the tree's height
+void bplusNodeTraversal(BPlusNode *node, int postorder)
+{
+    if (node == NULL)
+    {
+        return;
+    }
+    if (!postorder)
+    {
+        printBPlusNodeKeys(node);
+    }
+    if (!node->isLeaf)
+    {
+        for (int i = 0; i <= node->count; i++)
+        {
+            bplusNodeTraversal(BPLUS_CHILDREN(node)[i], postorder);
+        }
+    }
+    if (postorder)
+    {
+        printBPlusNodeKeys(node);
+    }
+}
+
+void binaryTreeDemo()
+{
+    clear();
+    printHeader();
+    printRetroBox("Binary Tree Visualization",
+                  "This section demonstrates Binary Tree operations\n"
+                  "with visual animations and traversal demonstrations.");
+
+    loadingAnimation("Initializing Binary Tree", 30);
+
+    TreeNode *root = NULL;
+    BPlusTree bplus = {NULL, 0, 0};
+    const char *modeNames[3] = {"Unbalanced BST", "AVL (self-balancing)", "B+ tree (32 keys per node)"};
+    int choice, value, high;
+
+    do
+    {
+        beginFrame();
+        
+        printRetroBox("Binary Tree Operations",
+                      "1. Insert Node\n"
+                      "2. Inorder Traversal\n"
+                      "3. Preorder Traversal\n"
+                      "4. Postorder Traversal\n"
+                      "5. Animate Tree Traversal\n"
+                      "6. Switch Tree Engine (BST / AVL / B+)\n"
+                      "7. Search Key\n"
+                      "8. Delete Key\n"
+                      "9. Range Scan (B+ tree)\n"
+                      "10. Focus View on Subtree\n"
+                      "11. Save Snapshot\n"
+                      "12. Load Snapshot\n"
+                      "13. Bulk Load from File\n"
+                      "14. Parallel Aggregates\n"
+                      "15. Instrumentation Stats\n"
+                      "0. Back to Main Menu");
+
+        framePrintf("\n\tTree Mode: %s\n", modeNames[treeMode]);
+        framePrintf("\n\tCurrent Binary Tree Structure:\n");
+        if (treeMode == TREE_MODE_BPLUS)
+        {
+            visualizeBPlusTree(&bplus, 22);
+        }
+        else
+        {
+            visualizeTreeViewport(root, 22);
+        }
+        framePrintf("\n\n");
+
+#ifdef _WIN32
+        frameColor(CYAN);
+#else
+        frameColor(CYAN);
+#endif
+
+        framePrintf("\t\tEnter operation choice: ");
+
+#ifdef _WIN32
+        frameColor(RESET);
+#else
+        frameColor(RESET);
+#endif
+        frameFlush();
+
+        if (scanf("%d", &choice) != 1)
+        {
+            while (getchar() != '\n')
+                ;
+            choice = -1;
+        }
+
+        switch (choice)
+        {
+        case 1:
+            printf("\t\tEnter value to insert: ");
+            if (scanf("%d", &value) != 1)
+            {
+                while (getchar() != '\n')
+                    ;
+                printf("\t\tInvalid input!\n");
+                SLEEP(1000);
+                break;
+            }
+            if (treeMode == TREE_MODE_BPLUS)
+            {
+                bplusInsert(&bplus, value);
+            }
+            else
+            {
+                root = insertTreeNode(root, value);
+            }
+
+#ifdef _WIN32
+            setColor(GREEN);
+#else
+            setColor(GREEN);
+#endif
+
+            printf("\t\tNode with value %d inserted successfully!\n", value);
+
+#ifdef _WIN32
+            setColor(RESET);
+#else
+            setColor(RESET);
+#endif
+
+            SLEEP(1000);
+            break;
+
+        case 2:
+            printf("\n\t\tInorder Traversal: ");
+
+#ifdef _WIN32
+            setColor(YELLOW);
+#else
+            setColor(YELLOW);
+#endif
+
+            if (treeMode == TREE_MODE_BPLUS)
+            {
+                bplusTraversal(&bplus);
+            }
+            else
+            {
+                inorderTraversal(root);
+            }
+
+#ifdef _WIN32
+            setColor(RESET);
+#else
+            setColor(RESET);
+#endif
+
+            printf("\n\t\tTraversal complete! Press any key...");
+            getch_wrapper();
+            break;
+
+        case 3:
+            printf("\n\t\tPreorder Traversal: ");
+
+#ifdef _WIN32
+            setColor(YELLOW);
+#else
+            setColor(YELLOW);
+#endif
+
+            if (treeMode == TREE_MODE_BPLUS)
+            {
+                bplusNodeTraversal(bplus.root, 0);
+            }
+            else
+            {
+                preorderTraversal(root);
+            }
+
+#ifdef _WIN32
+            setColor(RESET);
+#else
+            setColor(RESET);
+#endif
+
+            printf("\n\t\tTraversal complete! Press any key...");
+            getch_wrapper();
+            break;
+
+        case 4:
+            printf("\n\t\tPostorder Traversal: ");
+
+#ifdef _WIN32
+            setColor(YELLOW);
+#else
+            setColor(YELLOW);
+#endif
+
+            if (treeMode == TREE_MODE_BPLUS)
+            {
+                bplusNodeTraversal(bplus.root, 1);
+            }
+            else
+            {
+                postorderTraversal(root);
+            }
+
+#ifdef _WIN32
+            setColor(RESET);
+#else
+            setColor(RESET);
+#endif
+
+            printf("\n\t\tTraversal complete! Press any key...");
+            getch_wrapper();
+            break;
+
+        case 5:
+            printf("\n\t\tAnimating tree traversal...\n");
+
+            if (treeMode == TREE_MODE_BPLUS)
+            {
+                printf("\t\tLeaf chain (ascending): ");
+                bplusTraversal(&bplus);
+                printf("\n");
+
+                printf("\t\tPreorder (node, then children): ");
+                bplusNodeTraversal(bplus.root, 0);
+                printf("\n");
+
+                printf("\t\tPostorder (children, then node): ");
+                bplusNodeTraversal(bplus.root, 1);
+                printf("\n\n\t\tAnimation complete! Press any key...");
+                getch_wrapper();
+                break;
+            }
+
+            printf("\t\tInorder (L Root R): ");
+            inorderTraversal(root);
+            printf("\n");
+
+            printf("\t\tPreorder (Root L R): ");
+            preorderTraversal(root);
+            printf("\n");
+
+            printf("\t\tPostorder (L R Root): ");
+            postorderTraversal(root);
+            printf("\n");
+
+            printf("\t\tLevel order (top down): ");
+            levelorderTraversal(root);
+            printf("\n");
+
+            printf("\n\n\t\tAnimation complete! Press any key...");
+            getch_wrapper();
+            break;
+
+        case 6:
+            root = setTreeMode(root, &bplus, (treeMode + 1) % 3);
+
+#ifdef _WIN32
+            setColor(GREEN);
+#else
+            setColor(GREEN);
+#endif
+
+            if (treeMode == TREE_MODE_AVL)
+            {
+                printf("\t\tAVL mode on: tree rebalanced, inserts now stay O(log n)!\n");
+            }
+            else if (treeMode == TREE_MODE_BPLUS)
+            {
+                printf("\t\tB+ tree mode on: keys moved into wide, cache-friendly nodes!\n");
+            }
+            else
+            {
+                printf("\t\tPlain BST mode on: inserts no longer rebalance.\n");
+            }
+
+#ifdef _WIN32
+            setColor(RESET);
+#else
+            setColor(RESET);
+#endif
+
+            SLEEP(1000);
+            break;
+
+        case 7:
+        case 8:
+        case 9:
+            if (choice == 9 && treeMode != TREE_MODE_BPLUS)
+            {
+#ifdef _WIN32
+                setColor(RED);
+#else
+                setColor(RED);
+#endif
+
+                printf("\t\tSwitch to the B+ tree engine (option 6) first!\n");
+
+#ifdef _WIN32
+                setColor(RESET);
+#else
+                setColor(RESET);
+#endif
+
+                SLEEP(1000);
+                break;
+            }
+
+            printf(choice == 9 ? "\t\tEnter lower and upper bound: " : "\t\tEnter key: ");
+            if (scanf("%d", &value) != 1 || (choice == 9 && scanf("%d", &high) != 1))
+            {
+                while (getchar() != '\n')
+                    ;
+                printf("\t\tInvalid input!\n");
+                SLEEP(1000);
+                break;
+            }
+
+#ifdef _WIN32
+            setColor(YELLOW);
+#else
+            setColor(YELLOW);
+#endif
+
+            if (choice == 7)
+            {
+                int found = treeMode == TREE_MODE_BPLUS ? bplusSearch(&bplus, value)
+                                                        : searchTreeNode(root, value) != NULL;
+                printf("\t\tKey %d %s\n", value, found ? "found!" : "not found.");
+            }
+            else if (choice == 8)
+            {
+                int deleted;
+                if (treeMode == TREE_MODE_BPLUS)
+                {
+                    deleted = bplusDelete(&bplus, value);
+                }
+                else
+                {
+                    root = deleteTreeNode(root, value, &deleted);
+                }
+                printf("\t\tKey %d %s\n", value, deleted ? "deleted!" : "not found.");
+            }
+            else
+            {
+                printf("\t\tKeys in [%d, %d]: ", value, high);
+                bplusRangeScan(&bplus, value, high, printKeyAnimated, NULL);
+                printf("\n");
+            }
+
+#ifdef _WIN32
+            setColor(RESET);
+#else
+            setColor(RESET);
+#endif
+
+            printf("\t\tPress any key...");
+            getch_wrapper();
+            break;
+
+        case 10:
+            printf("\t\tKey to focus on (a key not in the tree shows all of it): ");
+            if (scanf("%d", &value) != 1)
+            {
+                while (getchar() != '\n')
+                    ;
+                printf("\t\tInvalid input!\n");
+                SLEEP(1000);
+                break;
+            }
+            // Checked against the tree on every redraw, so the focus survives
+            // rotations and falls back to the root if the key is deleted
+            treeViewFocused = 1;
+            treeViewKey = value;
+            break;
+
+        case 11:
+        case 12:
+        {
+            char path[256];
+            if (readFilePath("\t\tSnapshot file: ", path))
+            {
+                reportSnapshot(choice == 11 ? saveTreeSnapshot(root, &bplus, path)
+                                            : loadTreeSnapshot(path, &root, &bplus),
+                               choice == 11, path);
+            }
+            break;
+        }
+
+        case 13:
+        {
+            char path[256];
+            if (!readFilePath("\t\tFile of integers (sorted or not): ", path))
+            {
+                break;
+            }
+
+            long long read, start = nowNanos();
+            long long distinct = bulkLoadFile(path, &root, &bplus, &read);
+            long long elapsed = nowNanos() - start;
+            treeViewFocused = 0;
+
+#ifdef _WIN32
+            setColor(distinct < 0 ? RED : GREEN);
+#else
+            setColor(distinct < 0 ? RED : GREEN);
+#endif
+
+            if (distinct < 0)
+            {
+                printf("\t\tCould not open '%s'!\n", path);
+            }
+            else
+            {
+                printf("\t\tRead %lld keys; the tree now holds %lld distinct keys (%.1f ms)!\n",
+                       read, distinct, elapsed / 1e6);
+            }
+
+#ifdef _WIN32
+            setColor(RESET);
+#else
+            setColor(RESET);
+#endif
+
+            SLEEP(1500);
+            break;
+        }
+
+        case 14:
+        {
+            if (treeMode == TREE_MODE_BPLUS)
+            {
+#ifdef _WIN32
+                setColor(RED);
+#else
+                setColor(RED);
+#endif
+
+                printf("\t\tSwitch to the BST or AVL engine (option 6) first!\n");
+
+#ifdef _WIN32
+                setColor(RESET);
+#else
+                setColor(RESET);
+#endif
+
+                SLEEP(1000);
+                break;
+            }
+
+            int threads = onlineCores();
+            TreeSummary summary;
+            TreeReducer summaryReducer = {sizeof(TreeSummary), summaryInit, summaryVisit, summaryMerge, NULL};
+            long long start = nowNanos();
+            parallelTreeReduce(root, threads, &summaryReducer, &summary);
+            long long elapsed = nowNanos() - start;
+
+#ifdef _WIN32
+            setColor(YELLOW);
+#else
+            setColor(YELLOW);
+#endif
+
+            printf("\t\t%d worker thread(s), %.3f ms\n", threads, elapsed / 1e6);
+            if (summary.count == 0)
+            {
+                printf("\t\tThe tree is empty.\n");
+            }
+            else
+            {
+                printf("\t\tCount %lld, sum %lld, min %d, max %d, mean %.2f\n", summary.count, summary.sum,
+                       summary.min, summary.max, (double)summary.sum / summary.count);
+
+                // Eight equal-width buckets over [min, max], bars scaled to the fullest
+                TreeHistogram spec = {summary.min, summary.max, 8};
+                TreeReducer histogramReducer = {8 * sizeof(long long), treeHistogramInit, treeHistogramVisit,
+                                                treeHistogramMerge, &spec};
+                long long counts[8], fullest = 1;
+                parallelTreeReduce(root, threads, &histogramReducer, counts);
+                for (int b = 0; b < 8; b++)
+                {
+                    fullest = counts[b] > fullest ? counts[b] : fullest;
+                }
+
+                long long span = (long long)spec.high - spec.low + 1;
+                for (int b = 0; b < 8; b++)
+                {
+                    // Smallest key that lands in bucket b (keys map by floor(offset * 8 / span))
+                    long long from = spec.low + (b * span + 7) / 8;
+                    long long to = spec.low + ((b + 1) * span + 7) / 8 - 1;
+                    printf("\t\t[%11lld, %11lld] %10lld ", from, to, counts[b]);
+                    for (long long bar = 0; bar < counts[b] * 30 / fullest; bar++)
+                    {
+                        printf("#");
+                    }
+                    printf("\n");
+                }
+            }
+
+#ifdef _WIN32
+            setColor(RESET);
+#else
+            setColor(RESET);
+#endif
+
+            printf("\t\tPress any key...");
+            getch_wrapper();
+            break;
+        }
+        case 15:
+            showStatsPanel(root, &bplus);
+            break;
+
+        case 0:
+            break; // Exit loop
+        default:
+            printf("\t\tInvalid choice!\n");
+            SLEEP(2000);
+        }
+    } while (choice != 0);
+    treeViewFocused = 0;
+
+    // The main menu's stats panel shows the tree as it was left
+    recordTreeShape(root, &bplus);
+    freeAllTreeNodes();
+    freeBPlusTree(&bplus);
+}
+
+// Instrumentation Functions------------------------------------------------------------
+
+void statsMerge(DsStats *into, const DsStats *from)
+{
+    into->treeInserts += from->treeInserts;
+    into->treeInsertComparisons += from->treeInsertComparisons;
+    into->treeInsertVisits += from->treeInsertVisits;
+    into->listDeletes += from->listDeletes;
+    into->listDeleteComparisons += from->listDeleteComparisons;
+    into->listDeleteVisits += from->listDeleteVisits;
+    into->stackFull += from->stackFull;
+    into->stackEmpty += from->stackEmpty;
+    into->queueFull += from->queueFull;
+    into->queueEmpty += from->queueEmpty;
+    for (int i = 0; i < STAT_STRUCTURES; i++)
+    {
+        into->allocations[i] += from->allocations[i];
+        into->bytes[i] += from->bytes[i];
+    }
+}
+
+// Sets the treeSize and treeHeight gauges. The B+ tree keeps both; a BST
+// only keeps heights in AVL mode, so its nodes are walked with an explicit
+// stack, which stays small even when the tree has degenerated into a list
+void recordTreeShape(TreeNode *root, BPlusTree *bplus)
+{
+    if (treeMode == TREE_MODE_BPLUS)
+    {
+        dsStats.treeSize = bplus != NULL ? bplus->size : 0;
+        dsStats.treeHeight = bplus != NULL ? bplus->height : 0;
+        return;
+    }
+
+    long long size = 0, count = 0, capacity = 64;
+    int height = 0;
+    TreeNode **nodes = (TreeNode **)malloc(capacity * sizeof(TreeNode *));
+    int *depths = (int *)malloc(capacity * sizeof(int));
+    if (nodes == NULL || depths == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (root != NULL)
+    {
+        nodes[count] = root;
+        depths[count++] = 1;
+    }
+    while (count > 0)
+    {
+        TreeNode *node = nodes[--count];
+        int depth = depths[count];
+        size++;
+        height = depth > height ? depth : height;
+
+        if (count + 2 > capacity)
+        {
+            capacity *= 2;
+            nodes = (TreeNode **)realloc(nodes, capacity * sizeof(TreeNode *));
+            depths = (int *)realloc(depths, capacity * sizeof(int));
+            if (nodes == NULL || depths == NULL)
+            {
+                fprintf(stderr, "Memory allocation failed!\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        if (node->right != NULL)
+        {
+            nodes[count] = node->right;
+            depths[count++] = depth + 1;
+        }
+        if (node->left != NULL)
+        {
+            nodes[count] = node->left;
+            depths[count++] = depth + 1;
+        }
+    }
+
+    free(nodes);
+    free(depths);
+    dsStats.treeSize = size;
+    dsStats.treeHeight = height;
+}
+
+// Operations per call, or 0 before the first call
+double statsPerCall(long long total, long long calls)
+{
+    return calls > 0 ? (double)total / calls : 0.0;
+}
+
+// Counters of this session; root and bplus (both may be NULL) refresh the
+// tree gauges first
+void showStatsPanel(TreeNode *root, BPlusTree *bplus)
+{
+    static const char *structureNames[STAT_STRUCTURES] = {"Linked list", "Stack", "Queue", "Tree", "Skip list"};
+    char count[32], bytes[32];
+
+    if (root != NULL || bplus != NULL)
+    {
+        recordTreeShape(root, bplus);
+    }
+
+    beginFrame();
+    printRetroBox("Instrumentation Stats",
+                  DS_STATS ? "Counters since the program started.\n"
+                             "Deep tree inserts point at a degenerate tree."
+                           : "Counters are compiled out (built with DS_STATS=0).\n"
+                             "Rebuild without -DDS_STATS=0 to collect them.");
+
+#ifdef _WIN32
+    frameColor(CYAN);
+#else
+    frameColor(CYAN);
+#endif
+
+    framePrintf("\n\tTree inserts %14s: %.1f comparisons, %.1f nodes visited each\n",
+                formatCount(count, sizeof(count), dsStats.treeInserts),
+                statsPerCall(dsStats.treeInsertComparisons, dsStats.treeInserts),
+                statsPerCall(dsStats.treeInsertVisits, dsStats.treeInserts));
+    framePrintf("\tList deletes %14s: %.1f comparisons, %.1f nodes visited each\n",
+                formatCount(count, sizeof(count), dsStats.listDeletes),
+                statsPerCall(dsStats.listDeleteComparisons, dsStats.listDeletes),
+                statsPerCall(dsStats.listDeleteVisits, dsStats.listDeletes));
+    framePrintf("\tStack full   %14lld times (push grew it), empty %lld times (pop)\n",
+                dsStats.stackFull, dsStats.stackEmpty);
+    framePrintf("\tQueue full   %14lld times (enqueue grew it), empty %lld times (dequeue)\n",
+                dsStats.queueFull, dsStats.queueEmpty);
+
+    framePrintf("\n\t%-12s %16s %16s\n", "Allocations", "count", "bytes");
+    for (int i = 0; i < STAT_STRUCTURES; i++)
+    {
+        framePrintf("\t%-12s %16s %16s\n", structureNames[i],
+                    formatCount(count, sizeof(count), dsStats.allocations[i]),
+                    formatCount(bytes, sizeof(bytes), dsStats.bytes[i]));
+    }
+
+    // A balanced tree of n keys is ceil(log2(n + 1)) levels tall
+    int minimum = 0;
+    while (minimum < 63 && (1LL << minimum) - 1 < dsStats.treeSize)
+    {
+        minimum++;
+    }
+    framePrintf("\n\tTree shape   %14s keys, height %d (balanced: %d)\n",
+                formatCount(count, sizeof(count), dsStats.treeSize), dsStats.treeHeight, minimum);
+
+#ifdef _WIN32
+    frameColor(RESET);
+#else
+    frameColor(RESET);
+#endif
+
+    if (minimum > 0 && dsStats.treeHeight > 4 * minimum)
+    {
+#ifdef _WIN32
+        frameColor(RED);
+#else
+        frameColor(RED);
+#endif
+
+        framePrintf("\tThe tree is %.0fx taller than balanced: searches are close to O(n).\n",
+                    (double)dsStats.treeHeight / minimum);
+        framePrintf("\tSwitch to the AVL engine or bulk load it to rebalance.\n");
+
+#ifdef _WIN32
+        frameColor(RESET);
+#else
+        frameColor(RESET);
+#endif
+    }
+
+    framePrintf("\n\tPress any key...");
+    frameFlush();
+    getch_wrapper();
+}
+
+// The counters as one JSON object, for --stats and the script 'stats' command
+void writeStatsJson(FILE *out)
+{
+    static const char *structureKeys[STAT_STRUCTURES] = {"list", "stack", "queue", "tree", "skip"};
+
+    fprintf(out, "{\"enabled\": %d,\n", DS_STATS);
+    fprintf(out, " \"tree\": {\"inserts\": %lld, \"insert_comparisons\": %lld, \"insert_visits\": %lld, "
+                 "\"size\": %lld, \"height\": %d},\n",
+            dsStats.treeInserts, dsStats.treeInsertComparisons, dsStats.treeInsertVisits, dsStats.treeSize,
+            dsStats.treeHeight);
+    fprintf(out, " \"list\": {\"deletes\": %lld, \"delete_comparisons\": %lld, \"delete_visits\": %lld},\n",
+            dsStats.listDeletes, dsStats.listDeleteComparisons, dsStats.listDeleteVisits);
+    fprintf(out, " \"stack\": {\"full\": %lld, \"empty\": %lld},\n", dsStats.stackFull, dsStats.stackEmpty);
+    fprintf(out, " \"queue\": {\"full\": %lld, \"empty\": %lld},\n", dsStats.queueFull, dsStats.queueEmpty);
+    fprintf(out, " \"allocations\": {");
+    for (int i = 0; i < STAT_STRUCTURES; i++)
+    {
+        fprintf(out, "%s\"%s\": {\"count\": %lld, \"bytes\": %lld}", i > 0 ? ", " : "", structureKeys[i],
+                dsStats.allocations[i], dsStats.bytes[i]);
+    }
+    fprintf(out, "}}\n");
+    fflush(out);
+}
+
+// Writes the JSON to path ('-' is stdout); returns 0 on success
+int dumpStats(const char *path)
+{
+    FILE *out = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "Cannot write stats to '%s'\n", path);
+        return 1;
+    }
+    writeStatsJson(out);
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return 0;
+}
+
+// Batch Mode Functions----------------------------------------------------------------
+
+void printUsage(const char *program)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  (no options)        Start the interactive console application\n"
+            "  --bench N[,N...]    Benchmark every primitive at each size (1e3..1e8)\n"
+            "  --sizes N[,N...]    Same as --bench\n"
+            "  --dist LIST         Key distributions: seq,random,zipf (default random)\n"
+            "  --ops LIST          Only these primitives, e.g. push,pop,inorder\n"
+            "                      (insertNode deleteNode listScan unrolledInsert\n"
+            "                       unrolledDelete unrolledScan skipInsert skipSearch\n"
+            "                       skipDelete push pop enqueue dequeue snapshotSave\n"
+            "                       snapshotLoad\n"
+            "                       treeI64Insert treeI64Find treeStrInsert treeKvInsert\n"
+            "                       heapPush heapDecreaseKey heapPopMin heapify\n"
+            "                       insertTreeNode inorder preorder postorder\n"
+            "                       levelorder morrisInorder bulkLoad parallelReduce\n"
+            "                       parallelInsert\n"
+            "                       treeLookup lookupMany treeDelete [no lookupMany\n"
+            "                       for the B+ tree])\n"
+            "  --format FMT        Benchmark output: text, json or csv (default text)\n"
+            "  --batch K           Operations per latency sample (default 16; 1 times\n"
+            "                      every operation, at the cost of clock overhead)\n"
+            "  --perf              Add hardware counters per operation to --bench: cycles,\n"
+            "                      instructions, L1d/LLC/dTLB misses, branch misses (Linux;\n"
+            "                      counters the kernel refuses are reported as -)\n"
+            "  --spsc N            Move N messages producer->consumer thread through the\n"
+            "                      lock-free SPSC ring (plus a mutex Queue baseline)\n"
+            "  --publish-batch K   SPSC items written before the index is published (64)\n"
+            "  --mpmc N            Move N messages through the bounded MPMC ring, the\n"
+            "                      Michael-Scott queue and a mutex Queue, with 1, 2,\n"
+            "                      4... producer/consumer pairs\n"
+            "  --treiber N         N push/pop pairs on the Treiber stack (with and without\n"
+            "                      elimination) and a mutex Stack, 1, 2, 4... threads\n"
+            "  --skiplist N        N mixed operations (80%% search, 10%% insert, 10%% delete)\n"
+            "                      on the lock-free skip list and a mutex skip list, 1, 2,\n"
+            "                      4... threads\n"
+            "  --threads T         Most threads for --mpmc, --treiber, --skiplist and the\n"
+            "                      parallelReduce and parallelInsert ops (default: online\n"
+            "                      cores)\n"
+            "  --script FILE       Run the commands in FILE ('-' reads stdin)\n"
+            "  --capacity N        Initial stack/queue capacity for --script (default 16;\n"
+            "                      both grow on demand)\n"
+            "  --tree MODE         Tree engine: bst, avl or bplus (default bst)\n"
+            "  --bulk FILE         Bulk load the integers in FILE ('-' reads stdin) into a\n"
+            "                      balanced tree and report the time taken\n"
+            "  --seed N            Random seed for benchmark keys (default 1)\n"
+            "  --stats FILE        Write the instrumentation counters as JSON to FILE ('-'\n"
+            "                      is stdout) once everything else has run\n"
+            "  --trace FILE        Record every list, stack, queue and tree operation and\n"
+            "                      write them to FILE as Chrome trace JSON (open it in\n"
+            "                      ui.perfetto.dev or chrome://tracing)\n"
+            "  --help              Show this message\n"
+            "\n"
+            "Script commands, one per line ('#' starts a comment):\n"
+            "  list insert V | list delete V | list mode nodes|unrolled\n"
+            "  stack push V  | stack pop\n"
+            "  queue enqueue V | queue dequeue\n"
+            "  tree insert V | tree mode bst|avl|bplus | tree bulk FILE\n"
+            "  tree ingest FILE  (insert every key in FILE, in parallel for BST/AVL)\n"
+            "  tree search V | tree delete V\n"
+            "  tree range LOW HIGH  [B+ tree only]\n"
+            "  tree stats | tree filter LOW HIGH  [BST/AVL only; run in parallel]\n"
+            "  skip insert V | skip delete V | skip search V | skip range LOW HIGH\n"
+            "  print list|stack|queue|tree|skip\n"
+            "  save list|stack|queue|tree FILE | load list|stack|queue|tree FILE\n"
+            "  stats  (instrumentation counters as JSON)\n",
+            program);
+}
+
+// Benchmark Suite Functions-----------------------------------------------------------
+
+#define BENCH_FORMAT_TEXT 0
+#define BENCH_FORMAT_JSON 1
+#define BENCH_FORMAT_CSV 2
+
+#define BENCH_DIST_SEQUENTIAL 0
+#define BENCH_DIST_RANDOM 1
+#define BENCH_DIST_ZIPF 2
+
+#define BENCH_MAX_SIZES 16
+
+// Hardware counters for --perf: cycles, instructions, L1d misses, LLC
+// misses, branch misses and dTLB misses, reported per operation
+#define PERF_EVENTS 6
+
+const char *perfEventNames[PERF_EVENTS] = {"cycles", "instructions", "l1d_misses",
+                                           "llc_misses", "branch_misses", "dtlb_misses"};
+
+// Log-linear latency histogram: 16 linear sub-buckets per power of two,
+// so every percentile is exact to within ~6% using fixed memory
+#define HISTOGRAM_SUB_BUCKETS 16
+#define HISTOGRAM_BUCKETS (64 * HISTOGRAM_SUB_BUCKETS)
+
+typedef struct
+{
+    long long counts[HISTOGRAM_BUCKETS];
+    long long samples;
+} LatencyHistogram;
+
+typedef struct
+{
+    const char *operation;
+    const char *distribution;
+    long long size;
+    int threads;
+    double nsPerOp;
+    long long p50;
+    long long p99;
+    long long p999; // Percentiles are -1 when not measured (throughput runs)
+    long peakRssKb;
+    double perf[PERF_EVENTS]; // Per operation; -1 when the counter is unavailable
+} BenchResult;
+
+typedef struct
+{
+    long long sizes[BENCH_MAX_SIZES];
+    int sizeCount;
+    const char *distributions; // Comma-separated names
+    const char *operations;    // Comma-separated names, NULL runs everything
+    int format;
+    int batch; // Operations per latency sample
+    unsigned long long seed;
+    long long spscCount;    // Messages for the producer/consumer benchmark
+    size_t publishBatch;    // SPSC items per index publish
+    long long mpmcCount;    // Messages for the multi-producer scaling benchmark
+    long long treiberCount; // Push/pop pairs for the concurrent stack benchmark
+    long long skipCount;    // Mixed operations for the concurrent skip list benchmark
+    int threads;            // Most worker threads a scaling benchmark may use
+    int perf;               // Read hardware counters around each timed section
+} BenchConfig;
+
+// One descriptor per event rather than a group, so a CPU or VM that lacks
+// an event, or a perf_event_paranoid setting that forbids it, only loses
+// that column
+typedef struct
+{
+    int fds[PERF_EVENTS]; // -1 where the event could not be opened
+} PerfCounters;
+
+typedef struct
+{
+    FILE *out;
+    int format;
+    int results;
+    PerfCounters *perf; // NULL unless --perf
+} BenchReport;
+
+long long timerOverhead = 0;
+
+int histogramBucket(long long value)
+{
+    if (value < HISTOGRAM_SUB_BUCKETS)
+    {
+        return value < 0 ? 0 : (int)value;
+    }
+
+    int exponent = 63 - __builtin_clzll((unsigned long long)value);
+    int sub = (int)((value >> (exponent - 4)) & (HISTOGRAM_SUB_BUCKETS - 1));
+    return (exponent - 3) * HISTOGRAM_SUB_BUCKETS + sub;
+}
+
+long long histogramBucketValue(int bucket)
+{
+    if (bucket < HISTOGRAM_SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    int exponent = bucket / HISTOGRAM_SUB_BUCKETS + 3;
+    long long sub = bucket % HISTOGRAM_SUB_BUCKETS;
+    return (HISTOGRAM_SUB_BUCKETS + sub) << (exponent - 4);
+}
+
+void histogramRecord(LatencyHistogram *histogram, long long value)
+{
+    histogram->counts[histogramBucket(value)]++;
+    histogram->samples++;
+}
+
+long long histogramPercentile(LatencyHistogram *histogram, double percentile)
+{
+    long long target = (long long)(histogram->samples * percentile / 100.0);
+    long long seen = 0;
+
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        seen += histogram->counts[i];
+        if (seen > target)
+        {
+            return histogramBucketValue(i);
+        }
+    }
+    return 0;
+}
+
+// Median cost of one nowNanos() pair, subtracted from every sample so the
+// mean stays unbiased even for operations cheaper than the clock itself
+int compareLongLong(const void *a, const void *b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+void calibrateTimer()
+{
+    long long samples[1001];
+    for (int i = 0; i < 1001; i++)
+    {
+        long long start = nowNanos();
+        samples[i] = nowNanos() - start;
+    }
+    qsort(samples, 1001, sizeof(long long), compareLongLong);
+    timerOverhead = samples[500];
+}
+
+// Peak resident set size in KB. Linux reads VmHWM, which resetPeakRss()
+// can rewind so each benchmark reports its own peak; elsewhere the figure
+// is the high-water mark of the whole run
+long peakRssKb()
+{
+#ifdef _WIN32
+    return 0;
+#else
+#ifdef __linux__
+    FILE *status = fopen("/proc/self/status", "r");
+    if (status != NULL)
+    {
+        char line[128];
+        long peak = -1;
+        while (fgets(line, sizeof(line), status) != NULL)
+        {
+            if (sscanf(line, "VmHWM: %ld", &peak) == 1)
+            {
+                break;
+            }
+        }
+        fclose(status);
+        if (peak >= 0)
+        {
+            return peak;
+        }
+    }
+#endif
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // macOS reports bytes
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+void resetPeakRss()
+{
+#ifdef __linux__
+    int fd = open("/proc/self/clear_refs", O_WRONLY);
+    if (fd >= 0)
+    {
+        if (write(fd, "5", 1) < 0)
+        {
+            // Not permitted: keep reporting the process-wide peak
+        }
+        close(fd);
+    }
+#endif
+}
+
+// Opens the --perf counters for this thread and the threads it starts
+// later, counting user space only. Where perf_event_open is missing or
+// refused the affected counters read as unavailable and the run goes on
+void perfOpen(PerfCounters *counters)
+{
+    int opened = 0, error = 0;
+    for (int i = 0; i < PERF_EVENTS; i++)
+    {
+        counters->fds[i] = -1;
+    }
+
+#ifdef __linux__
+    static const uint32_t types[PERF_EVENTS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                                PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+    static const uint64_t configs[PERF_EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES, // Last-level cache
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+
+    for (int i = 0; i < PERF_EVENTS; i++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = types[i];
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.inherit = 1; // Worker threads of the parallel ops count too
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        counters->fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (counters->fds[i] >= 0)
+        {
+            opened++;
+        }
+        else if (error == 0)
+        {
+            error = errno;
+        }
+    }
+#endif
+
+    if (opened < PERF_EVENTS)
+    {
+        fprintf(stderr, "--perf: %d of %d hardware counters unavailable (%s); reported as -\n",
+                PERF_EVENTS - opened, PERF_EVENTS,
+                error != 0 ? strerror(error) : "perf_event_open needs Linux");
+    }
+}
+
+void perfStart(PerfCounters *counters)
+{
+#ifdef __linux__
+    for (int i = 0; i < PERF_EVENTS; i++)
+    {
+        if (counters->fds[i] >= 0)
+        {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    (void)counters;
+#endif
+}
+
+// Stops the counters and stores each count per operation in perf. Counts
+// are scaled up when the kernel had to multiplex the events
+void perfStop(PerfCounters *counters, double *perf, long long operations)
+{
+    for (int i = 0; i < PERF_EVENTS; i++)
+    {
+        perf[i] = -1;
+#ifdef __linux__
+        uint64_t values[3]; // Count, time enabled, time running
+        if (counters->fds[i] < 0)
+        {
+            continue;
+        }
+        ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counters->fds[i], values, sizeof(values)) == (ssize_t)sizeof(values) && values[2] > 0 &&
+            operations > 0)
+        {
+            perf[i] = (double)values[0] * ((double)values[1] / values[2]) / operations;
+        }
+#else
+        (void)counters;
+        (void)operations;
+#endif
+    }
+}
+
+void perfClose(PerfCounters *counters)
+{
+    for (int i = 0; i < PERF_EVENTS; i++)
+    {
+        if (counters->fds[i] >= 0)
+        {
+            close(counters->fds[i]);
+        }
+    }
+}
+
+int csvContains(const char *list, const char *name)
+{
+    if (list == NULL)
+    {
+        return 1;
+    }
+
+    size_t length = strlen(name);
+    const char *p = list;
+    while (*p != '\0')
+    {
+        const char *end = strchr(p, ',');
+        size_t itemLength = end ? (size_t)(end - p) : strlen(p);
+        if (itemLength == length && strncmp(p, name, length) == 0)
+        {
+            return 1;
+        }
+        if (end == NULL)
+        {
+            break;
+        }
+        p = end + 1;
+    }
+    return 0;
+}
+
+// Zipfian ranks (theta 0.99) using the method of Gray et al., "Quickly
+// generating billion-record synthetic databases"
+double zipfZeta(long long n, double theta)
+{
+    long long exact = n < 1000000 ? n : 1000000;
+    double sum = 0;
+    for (long long i = 1; i <= exact; i++)
+    {
+        sum += 1.0 / pow((double)i, theta);
+    }
+    if (n > exact)
+    {
+        // Integral approximation of the remaining tail
+        sum += (pow((double)n, 1 - theta) - pow((double)exact, 1 - theta)) / (1 - theta);
+    }
+    return sum;
+}
+
+int *generateKeys(long long count, int distribution, unsigned long long seed)
+{
+    int *keys = (int *)malloc((size_t)count * sizeof(int));
+    if (keys == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned long long rng = seed ? seed : 1;
+
+    if (distribution == BENCH_DIST_SEQUENTIAL)
+    {
+        for (long long i = 0; i < count; i++)
+        {
+            keys[i] = (int)i;
+        }
+    }
+    else if (distribution == BENCH_DIST_RANDOM)
+    {
+        for (long long i = 0; i < count; i++)
+        {
+            keys[i] = (int)(nextRandom(&rng) & 0x7fffffff);
+        }
+    }
+    else
+    {
+        double theta = 0.99;
+        double zetan = zipfZeta(count, theta);
+        double zeta2 = 1.0 + 1.0 / pow(2.0, theta);
+        double alpha = 1.0 / (1.0 - theta);
+        double eta = (1.0 - pow(2.0 / count, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+
+        for (long long i = 0; i < count; i++)
+        {
+            double u = (nextRandom(&rng) >> 11) * (1.0 / 9007199254740992.0);
+            double uz = u * zetan;
+            long long rank;
+            if (uz < 1.0)
+            {
+                rank = 0;
+            }
+            else if (uz < zeta2)
+            {
+                rank = 1;
+            }
+            else
+            {
+                rank = (long long)(count * pow(eta * u - eta + 1.0, alpha));
+            }
+            keys[i] = (int)(rank < count ? rank : count - 1);
+        }
+    }
+    return keys;
+}
+
+// Renders a percentile for the report; unmeasured ones become null/empty/-
+const char *formatPerfValue(char *buffer, size_t length, double value, int format)
+{
+    if (value >= 0)
+    {
+        snprintf(buffer, length, "%.2f", value);
+    }
+    else
+    {
+        snprintf(buffer, length, "%s", format == BENCH_FORMAT_JSON ? "null" : format == BENCH_FORMAT_CSV ? "" : "-");
+    }
+    return buffer;
+}
+
+const char *formatPercentile(char *buffer, size_t length, long long value, int format)
+{
+    if (value >= 0)
+    {
+        snprintf(buffer, length, "%lld", value);
+    }
+    else
+    {
+        snprintf(buffer, length, "%s", format == BENCH_FORMAT_JSON ? "null" : format == BENCH_FORMAT_CSV ? "" : "-");
+    }
+    return buffer;
+}
+
+void reportResult(BenchReport *report, BenchResult *result)
+{
+    double opsPerSecond = result->nsPerOp > 0 ? 1e9 / result->nsPerOp : 0.0;
+    char p50[24], p99[24], p999[24];
+    formatPercentile(p50, sizeof(p50), result->p50, report->format);
+    formatPercentile(p99, sizeof(p99), result->p99, report->format);
+    formatPercentile(p999, sizeof(p999), result->p999, report->format);
+
+    if (report->format == BENCH_FORMAT_JSON)
+    {
+        fprintf(report->out,
+                "%s  {\"op\": \"%s\", \"dist\": \"%s\", \"size\": %lld, \"threads\": %d, "
+                "\"ns_per_op\": %.2f, \"ops_per_sec\": %.0f, "
+                "\"p50_ns\": %s, \"p99_ns\": %s, \"p999_ns\": %s, "
+                "\"peak_rss_kb\": %ld",
+                report->results ? ",\n" : "",
+                result->operation, result->distribution, result->size, result->threads,
+                result->nsPerOp, opsPerSecond, p50, p99, p999, result->peakRssKb);
+    }
+    else if (report->format == BENCH_FORMAT_CSV)
+    {
+        fprintf(report->out, "%s,%s,%lld,%d,%.2f,%.0f,%s,%s,%s,%ld",
+                result->operation, result->distribution, result->size, result->threads,
+                result->nsPerOp, opsPerSecond, p50, p99, p999, result->peakRssKb);
+    }
+    else
+    {
+        fprintf(report->out, "%-18s %-10s %12lld %7d %10.1f %14.0f %8s %8s %8s %10ld",
+                result->operation, result->distribution, result->size, result->threads,
+                result->nsPerOp, opsPerSecond, p50, p99, p999, result->peakRssKb);
+    }
+
+    if (report->perf != NULL)
+    {
+        char value[32];
+        for (int i = 0; i < PERF_EVENTS; i++)
+        {
+            formatPerfValue(value, sizeof(value), result->perf[i], report->format);
+            if (report->format == BENCH_FORMAT_JSON)
+            {
+                fprintf(report->out, ", \"%s_per_op\": %s", perfEventNames[i], value);
+            }
+            else
+            {
+                fprintf(report->out, report->format == BENCH_FORMAT_CSV ? ",%s" : " %9s", value);
+            }
+        }
+    }
+    fprintf(report->out, report->format == BENCH_FORMAT_JSON ? "}" : "\n");
+    fflush(report->out);
+    report->results++;
+}
+
+// Reports an aggregate-throughput run, where per-operation latency is not
+// sampled: ns/op is wall time divided by the operations of all threads
+void reportThroughput(BenchReport *report, const char *operation, const char *label,
+                      long long operations, int threads, long long nanos)
+{
+    BenchResult result = {0};
+    result.operation = operation;
+    result.distribution = label;
+    result.size = operations;
+    result.threads = threads;
+    result.nsPerOp = operations > 0 ? (double)nanos / operations : 0.0;
+    result.p50 = result.p99 = result.p999 = -1;
+    result.peakRssKb = peakRssKb();
+    for (int i = 0; i < PERF_EVENTS; i++)
+    {
+        result.perf[i] = -1; // Only the timed sections of benchmarkOneSize are counted
+    }
+    reportResult(report, &result);
+}
+
+void finishResult(BenchReport *report, BenchResult *result, LatencyHistogram *histogram,
+                  long long totalNanos, long long operations)
+{
+    result->nsPerOp = operations > 0 && totalNanos > 0 ? (double)totalNanos / operations : 0.0;
+    result->p50 = histogramPercentile(histogram, 50.0);
+    result->p99 = histogramPercentile(histogram, 99.0);
+    result->p999 = histogramPercentile(histogram, 99.9);
+    result->peakRssKb = peakRssKb();
+    if (report->perf != NULL)
+    {
+        perfStop(report->perf, result->perf, operations);
+    }
+    reportResult(report, result);
+}
+
+// Times `statement` in groups of `batch` consecutive iterations with the
+// timer's own cost removed. Each group adds one per-operation sample to the
+// histogram (clamped at zero) and its unclamped time to the total, so ns/op
+// stays unbiased for operations cheaper than the clock itself
+#define BENCH_LOOP(histogram, total, count, batch, statement)              \
+    do                                                                     \
+    {                                                                      \
+        for (long long i = 0; i < (count);)                                \
+        {                                                                  \
+            long long groupEnd = i + (batch) < (count) ? i + (batch) : (count); \
+            long long groupSize = groupEnd - i;                            \
+            long long groupStart = nowNanos();                             \
+            for (; i < groupEnd; i++)                                      \
+            {                                                              \
+                statement;                                                 \
+            }                                                              \
+            long long groupTime = nowNanos() - groupStart - timerOverhead; \
+            histogramRecord((histogram), groupTime < 0 ? 0 : groupTime / groupSize); \
+            (total) += groupTime;                                          \
+        }                                                                  \
+    } while (0)
+
+void countVisit(int value, void *context)
+{
+    *(long long *)context += value & 1;
+}
+
+void countNode(int value, void *context)
+{
+    (void)value;
+    (*(long long *)context)++;
+}
+
+// One call per (size, distribution): every selected primitive is timed on
+// the same key sequence; structures a timed step depends on are built untimed
+void benchmarkOneSize(BenchConfig *config, BenchReport *report, long long size,
+                      int distribution, const char *distributionName)
+{
+    LatencyHistogram *histogram = (LatencyHistogram *)malloc(sizeof(LatencyHistogram));
+    if (histogram == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int *keys = generateKeys(size, distribution, config->seed);
+    BenchResult result = {0};
+    result.distribution = distributionName;
+    result.size = size;
+    result.threads = 1;
+    long long total;
+
+#define BENCH_BEGIN(name)                             \
+    memset(histogram, 0, sizeof(LatencyHistogram));  \
+    resetPeakRss();                                   \
+    result.operation = name;                          \
+    total = 0;                                        \
+    if (report->perf != NULL)                         \
+    {                                                 \
+        perfStart(report->perf);                      \
+    }
+
+    // Linked list: append every key, scan, then delete in insertion order.
+    // A scan is one sample, repeated like the tree traversals, and reported
+    // per element
+    long long scanRepetitions = size >= 1000000 ? 3 : 3000000 / size;
+    if (csvContains(config->operations, "insertNode") || csvContains(config->operations, "deleteNode") ||
+        csvContains(config->operations, "listScan"))
+    {
+        LinkedList list = {NULL, NULL, 0};
+
+        BENCH_BEGIN("insertNode");
+        BENCH_LOOP(histogram, total, size, config->batch, insertNode(&list, keys[i]));
+        if (csvContains(config->operations, "insertNode"))
+        {
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        if (csvContains(config->operations, "listScan"))
+        {
+            long long sink = 0;
+            BENCH_BEGIN("listScan");
+            for (long long r = 0; r < scanRepetitions; r++)
+            {
+                long long start = nowNanos();
+                for (Node *current = list.head; current != NULL; current = current->next)
+                {
+                    sink += current->data & 1;
+                }
+                long long elapsed = nowNanos() - start - timerOverhead;
+                total += elapsed;
+                histogramRecord(histogram, elapsed / size);
+            }
+            finishResult(report, &result, histogram, total, scanRepetitions * size);
+            if (sink < 0)
+            {
+                printf("%lld", sink); // Keeps the scan from being optimized away
+            }
+        }
+
+        if (csvContains(config->operations, "deleteNode"))
+        {
+            BENCH_BEGIN("deleteNode");
+            BENCH_LOOP(histogram, total, size, config->batch, deleteNode(&list, keys[i]));
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        freeAllListNodes();
+    }
+
+    // The same three on the unrolled list
+    if (csvContains(config->operations, "unrolledInsert") || csvContains(config->operations, "unrolledDelete") ||
+        csvContains(config->operations, "unrolledScan"))
+    {
+        UnrolledList list = {NULL, NULL, 0, 0};
+
+        BENCH_BEGIN("unrolledInsert");
+        BENCH_LOOP(histogram, total, size, config->batch, unrolledInsert(&list, keys[i]));
+        if (csvContains(config->operations, "unrolledInsert"))
+        {
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        if (csvContains(config->operations, "unrolledScan"))
+        {
+            long long sink = 0;
+            BENCH_BEGIN("unrolledScan");
+            for (long long r = 0; r < scanRepetitions; r++)
+            {
+                long long start = nowNanos();
+                for (ListChunk *chunk = list.head; chunk != NULL; chunk = chunk->next)
+                {
+                    for (int i = 0; i < chunk->count; i++)
+                    {
+                        sink += chunk->values[i] & 1;
+                    }
+                }
+                long long elapsed = nowNanos() - start - timerOverhead;
+                total += elapsed;
+                histogramRecord(histogram, elapsed / size);
+            }
+            finishResult(report, &result, histogram, total, scanRepetitions * size);
+            if (sink < 0)
+            {
+                printf("%lld", sink);
+            }
+        }
+
+        if (csvContains(config->operations, "unrolledDelete"))
+        {
+            BENCH_BEGIN("unrolledDelete");
+            BENCH_LOOP(histogram, total, size, config->batch, unrolledDelete(&list, keys[i]));
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        freeAllListChunks();
+    }
+
+    // Skip list: insert every key, look each one up, then delete them all
+    if (csvContains(config->operations, "skipInsert") || csvContains(config->operations, "skipSearch") ||
+        csvContains(config->operations, "skipDelete"))
+    {
+        SkipList *skip = createSkipList();
+
+        BENCH_BEGIN("skipInsert");
+        BENCH_LOOP(histogram, total, size, config->batch, skipInsert(skip, keys[i]));
+        if (csvContains(config->operations, "skipInsert"))
+        {
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        if (csvContains(config->operations, "skipSearch"))
+        {
+            long long found = 0;
+            BENCH_BEGIN("skipSearch");
+            BENCH_LOOP(histogram, total, size, config->batch, found += skipSearch(skip, keys[i]));
+            finishResult(report, &result, histogram, total, size);
+            if (found != size)
+            {
+                fprintf(stderr, "skipSearch: only %lld of %lld keys found\n", found, size);
+            }
+        }
+
+        if (csvContains(config->operations, "skipDelete"))
+        {
+            BENCH_BEGIN("skipDelete");
+            BENCH_LOOP(histogram, total, size, config->batch, skipDelete(skip, keys[i]));
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        freeSkipList(skip);
+    }
+
+    if (csvContains(config->operations, "treeI64Insert") || csvContains(config->operations, "treeI64Find"))
+    {
+        TreeI64 tree = {NULL, 0};
+
+        BENCH_BEGIN("treeI64Insert");
+        BENCH_LOOP(histogram, total, size, config->batch, treeI64Insert(&tree, keys[i]));
+        if (csvContains(config->operations, "treeI64Insert"))
+        {
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        if (csvContains(config->operations, "treeI64Find"))
+        {
+            long long found = 0;
+            BENCH_BEGIN("treeI64Find");
+            BENCH_LOOP(histogram, total, size, config->batch, found += treeI64Find(&tree, keys[i]) != NULL);
+            finishResult(report, &result, histogram, total, size);
+            if (found != size)
+            {
+                fprintf(stderr, "treeI64Find: only %lld of %lld keys found\n", found, size);
+            }
+        }
+
+        treeI64FreeAll();
+    }
+
+    if (csvContains(config->operations, "treeStrInsert"))
+    {
+        // Keys are formatted up front so the loop times the tree, not snprintf
+        KeyString *names = (KeyString *)malloc(size * sizeof(KeyString));
+        if (names == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+        for (long long i = 0; i < size; i++)
+        {
+            char text[32];
+            snprintf(text, sizeof(text), "key-%011d", keys[i]);
+            names[i] = makeKeyString(text);
+        }
+
+        TreeStr tree = {NULL, 0};
+        BENCH_BEGIN("treeStrInsert");
+        BENCH_LOOP(histogram, total, size, config->batch, treeStrInsert(&tree, names[i]));
+        finishResult(report, &result, histogram, total, size);
+
+        treeStrFreeAll();
+        free(names);
+    }
+
+    if (csvContains(config->operations, "treeKvInsert"))
+    {
+        TreeKv tree = {NULL, 0};
+
+        BENCH_BEGIN("treeKvInsert");
+        BENCH_LOOP(histogram, total, size, config->batch,
+                   treeKvInsert(&tree, (KeyPayload){keys[i], i}));
+        finishResult(report, &result, histogram, total, size);
+
+        treeKvFreeAll();
+    }
+
+    // Every key gets its own id, so sizes past the id cap are left out
+    int wantHeapQueue = csvContains(config->operations, "heapPush") ||
+                        csvContains(config->operations, "heapDecreaseKey") ||
+                        csvContains(config->operations, "heapPopMin");
+    int wantHeap = wantHeapQueue || csvContains(config->operations, "heapify");
+    if (wantHeap && size > HEAP_MAX_ID + 1LL)
+    {
+        fprintf(stderr, "heap: size %lld is over the %d ids a PriorityQueue indexes, skipped\n", size,
+                HEAP_MAX_ID + 1);
+        wantHeap = 0;
+    }
+
+    if (wantHeap && wantHeapQueue)
+    {
+        // Starts small like the Stack: growth is part of what heapPush measures
+        PriorityQueue *heap = createPriorityQueue(16);
+
+        BENCH_BEGIN("heapPush");
+        BENCH_LOOP(histogram, total, size, config->batch, heapPush(heap, (int)i, keys[i]));
+        if (csvContains(config->operations, "heapPush"))
+        {
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        if (csvContains(config->operations, "heapDecreaseKey"))
+        {
+            BENCH_BEGIN("heapDecreaseKey");
+            BENCH_LOOP(histogram, total, size, config->batch, heapDecreaseKey(heap, (int)i, keys[i] - (int)(i & 1023)));
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        if (csvContains(config->operations, "heapPopMin"))
+        {
+            int id, key, previous = INT_MIN;
+            long long disorder = 0;
+            BENCH_BEGIN("heapPopMin");
+            BENCH_LOOP(histogram, total, size, config->batch, heapPopMin(heap, &id, &key);
+                       disorder += key < previous; previous = key);
+            finishResult(report, &result, histogram, total, size);
+            if (disorder != 0)
+            {
+                fprintf(stderr, "heapPopMin: %lld keys out of order\n", disorder);
+            }
+        }
+
+        freePriorityQueue(heap);
+    }
+
+    if (wantHeap && csvContains(config->operations, "heapify"))
+    {
+        // One sample is a whole build, reported per key to compare with heapPush
+        long long repetitions = size >= 1000000 ? 3 : 3000000 / size;
+        PriorityQueue *heap = createPriorityQueue(16);
+        int *ids = (int *)malloc(size * sizeof(int));
+        if (ids == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+        for (long long i = 0; i < size; i++)
+        {
+            ids[i] = (int)i;
+        }
+
+        BENCH_BEGIN("heapify");
+        for (long long r = 0; r < repetitions; r++)
+        {
+            long long start = nowNanos();
+            heapify(heap, ids, keys, (int)size);
+            long long elapsed = nowNanos() - start - timerOverhead;
+            total += elapsed;
+            histogramRecord(histogram, elapsed / size);
+        }
+        finishResult(report, &result, histogram, total, repetitions * size);
+
+        freePriorityQueue(heap);
+        free(ids);
+    }
+
+    if (csvContains(config->operations, "push") || csvContains(config->operations, "pop"))
+    {
+        // Starts small: growth is part of what push measures
+        Stack *stack = createStack(16);
+
+        BENCH_BEGIN("push");
+        BENCH_LOOP(histogram, total, size, config->batch, push(stack, keys[i]));
+        if (csvContains(config->operations, "push"))
+        {
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        if (csvContains(config->operations, "pop"))
+        {
+            BENCH_BEGIN("pop");
+            BENCH_LOOP(histogram, total, size, config->batch, pop(stack));
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        freeStack(stack);
+    }
+
+    if (csvContains(config->operations, "enqueue") || csvContains(config->operations, "dequeue"))
+    {
+        Queue *queue = createQueue(16);
+
+        BENCH_BEGIN("enqueue");
+        BENCH_LOOP(histogram, total, size, config->batch, enqueue(queue, keys[i]));
+        if (csvContains(config->operations, "enqueue"))
+        {
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        if (csvContains(config->operations, "dequeue"))
+        {
+            BENCH_BEGIN("dequeue");
+            BENCH_LOOP(histogram, total, size, config->batch, dequeue(queue));
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        freeQueue(queue);
+    }
+
+    if (csvContains(config->operations, "snapshotSave") || csvContains(config->operations, "snapshotLoad"))
+    {
+        // The queue is left wrapped with an odd-length front run, the layout
+        // whose two runs must chain into the checksum the loader computes.
+        // One sample is a whole save or load, reported per key; afterwards
+        // the file is loaded once more and compared key by key
+        const char *path = "bench_snapshot.tmp";
+        long long repetitions = size >= 1000000 ? 3 : 3000000 / size;
+        // Placeholders fill the ring's start and leave after the keys fill
+        // the rest, so the last keys wrap to index 0. An emptied ring resets
+        // to the start, hence the keys go in before the placeholders leave
+        int capacity = (int)size + 2;
+        int skip = size % 2 == 0 ? 3 : 4;
+        Queue *queue = createQueue(capacity);
+        queue->autoShrink = 0;
+        for (int i = 0; i < skip; i++)
+        {
+            enqueue(queue, 0);
+        }
+        for (long long i = 0; i < capacity - skip; i++)
+        {
+            enqueue(queue, keys[i]);
+        }
+        for (int i = 0; i < skip; i++)
+        {
+            dequeue(queue);
+        }
+        for (long long i = capacity - skip; i < size; i++)
+        {
+            enqueue(queue, keys[i]);
+        }
+
+        int saved = 1;
+        BENCH_BEGIN("snapshotSave");
+        for (long long r = 0; r < repetitions && saved; r++)
+        {
+            long long start = nowNanos();
+            saved = saveQueueSnapshot(queue, path);
+            long long elapsed = nowNanos() - start - timerOverhead;
+            total += elapsed;
+            histogramRecord(histogram, elapsed / size);
+        }
+        if (csvContains(config->operations, "snapshotSave") && saved)
+        {
+            finishResult(report, &result, histogram, total, repetitions * size);
+        }
+
+        if (csvContains(config->operations, "snapshotLoad") && saved)
+        {
+            BENCH_BEGIN("snapshotLoad");
+            for (long long r = 0; r < repetitions; r++)
+            {
+                long long start = nowNanos();
+                Queue *loaded = loadQueueSnapshot(path);
+                long long elapsed = nowNanos() - start - timerOverhead;
+                total += elapsed;
+                histogramRecord(histogram, elapsed / size);
+                if (loaded != NULL)
+                {
+                    freeQueue(loaded);
+                }
+            }
+            finishResult(report, &result, histogram, total, repetitions * size);
+        }
+
+        Queue *loaded = saved ? loadQueueSnapshot(path) : NULL;
+        long long intact = 0;
+        if (loaded != NULL && queueSize(loaded) == size)
+        {
+            while (intact < size && dequeue(loaded) == keys[intact])
+            {
+                intact++;
+            }
+        }
+        if (intact != size)
+        {
+            fprintf(stderr, "snapshot: the wrapped queue did not load back intact from %s\n", path);
+        }
+        if (loaded != NULL)
+        {
+            freeQueue(loaded);
+        }
+        freeQueue(queue);
+        remove(path);
+    }
+
+    int wantTraversal = csvContains(config->operations, "inorder") ||
+                        csvContains(config->operations, "preorder") ||
+                        csvContains(config->operations, "postorder") ||
+                        csvContains(config->operations, "levelorder") ||
+                        csvContains(config->operations, "morrisInorder");
+
+    int wantTreeLookup = csvContains(config->operations, "treeLookup") ||
+                         csvContains(config->operations, "lookupMany") ||
+                         csvContains(config->operations, "treeDelete");
+
+    if (treeMode == TREE_MODE_BPLUS &&
+        (csvContains(config->operations, "insertTreeNode") || wantTraversal || wantTreeLookup))
+    {
+        BPlusTree bplus = {NULL, 0, 0};
+
+        BENCH_BEGIN("insertTreeNode");
+        BENCH_LOOP(histogram, total, size, config->batch, bplusInsert(&bplus, keys[i]));
+        if (csvContains(config->operations, "insertTreeNode"))
+        {
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        // Only in-order has a meaning for a B+ tree: the leaf chain scan
+        long long nodes = bplus.size;
+        if (csvContains(config->operations, "inorder") && nodes > 0)
+        {
+            long long repetitions = size >= 1000000 ? 3 : 3000000 / size;
+            long long sink = 0;
+            BENCH_BEGIN("inorder");
+            for (long long r = 0; r < repetitions; r++)
+            {
+                long long start = nowNanos();
+                bplusRangeScan(&bplus, INT_MIN, INT_MAX, countVisit, &sink);
+                long long elapsed = nowNanos() - start - timerOverhead;
+                total += elapsed;
+                histogramRecord(histogram, elapsed / nodes);
+            }
+            finishResult(report, &result, histogram, total, repetitions * nodes);
+            if (sink < 0)
+            {
+                printf("%lld", sink); // Keeps the scan from being optimized away
+            }
+        }
+
+        if (csvContains(config->operations, "treeLookup"))
+        {
+            long long found = 0;
+            BENCH_BEGIN("treeLookup");
+            BENCH_LOOP(histogram, total, size, config->batch, found += bplusSearch(&bplus, keys[i]));
+            finishResult(report, &result, histogram, total, size);
+            if (found != size)
+            {
+                fprintf(stderr, "treeLookup: only %lld of %lld keys found\n", found, size);
+            }
+        }
+
+        if (csvContains(config->operations, "treeDelete"))
+        {
+            BENCH_BEGIN("treeDelete");
+            BENCH_LOOP(histogram, total, size, config->batch, bplusDelete(&bplus, keys[i]));
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        freeBPlusTree(&bplus);
+    }
+    else if (csvContains(config->operations, "insertTreeNode") || wantTraversal || wantTreeLookup ||
+             csvContains(config->operations, "parallelReduce"))
+    {
+        TreeNode *root = NULL;
+
+        BENCH_BEGIN("insertTreeNode");
+        BENCH_LOOP(histogram, total, size, config->batch, root = insertTreeNode(root, keys[i]));
+        if (csvContains(config->operations, "insertTreeNode"))
+        {
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        // A traversal is one sample; it is repeated so short walks still
+        // produce a distribution, and latencies are reported per visited node
+        // (duplicate keys are dropped, so the tree may be smaller than size)
+        const char *names[5] = {"inorder", "preorder", "postorder", "levelorder", "morrisInorder"};
+        long long repetitions = size >= 1000000 ? 3 : 3000000 / size;
+        long long nodes = 0;
+        treeWalk(root, TREE_ORDER_INORDER, countNode, &nodes);
+
+        for (int w = 0; w < 5 && nodes > 0; w++)
+        {
+            if (!csvContains(config->operations, names[w]))
+            {
+                continue;
+            }
+
+            long long sink = 0;
+            BENCH_BEGIN(names[w]);
+            for (long long r = 0; r < repetitions; r++)
+            {
+                long long start = nowNanos();
+                if (w == 4)
+                {
+                    morrisInorderWalk(root, countVisit, &sink);
+                }
+                else
+                {
+                    treeWalk(root, w, countVisit, &sink); // names[] follows TREE_ORDER_*
+                }
+                long long elapsed = nowNanos() - start - timerOverhead;
+                total += elapsed;
+                histogramRecord(histogram, elapsed / nodes);
+            }
+            finishResult(report, &result, histogram, total, repetitions * nodes);
+            if (sink < 0)
+            {
+                printf("%lld", sink); // Keeps the walk from being optimized away
+            }
+        }
+
+        if (csvContains(config->operations, "treeLookup"))
+        {
+            long long found = 0;
+            BENCH_BEGIN("treeLookup");
+            BENCH_LOOP(histogram, total, size, config->batch, found += searchTreeNode(root, keys[i]) != NULL);
+            finishResult(report, &result, histogram, total, size);
+            if (found != size)
+            {
+                fprintf(stderr, "treeLookup: only %lld of %lld keys found\n", found, size);
+            }
+        }
+
+        if (csvContains(config->operations, "lookupMany"))
+        {
+            // One sample is one lookupMany call over batch keys per lane, so
+            // the lanes stay full for most of it
+            long long group = (long long)config->batch * TREE_LOOKUP_LANES;
+            long long found = 0;
+            BENCH_BEGIN("lookupMany");
+            for (long long i = 0; i < size; i += group)
+            {
+                long long groupSize = size - i < group ? size - i : group;
+                long long start = nowNanos();
+                found += lookupMany(root, keys + i, groupSize, NULL);
+                long long elapsed = nowNanos() - start - timerOverhead;
+                histogramRecord(histogram, elapsed < 0 ? 0 : elapsed / groupSize);
+                total += elapsed;
+            }
+            finishResult(report, &result, histogram, total, size);
+            if (found != size)
+            {
+                fprintf(stderr, "lookupMany: only %lld of %lld keys found\n", found, size);
+            }
+        }
+
+        if (csvContains(config->operations, "parallelReduce") && nodes > 0)
+        {
+            // Summary reduction on 1, 2, 4... workers up to --threads; the
+            // 1-worker row is a plain sequential walk, the speedup baseline
+            int maxThreads = config->threads > 0 ? config->threads : onlineCores();
+            maxThreads = maxThreads < TREE_PARALLEL_MAX_THREADS ? maxThreads : TREE_PARALLEL_MAX_THREADS;
+            TreeReducer reducer = {sizeof(TreeSummary), summaryInit, summaryVisit, summaryMerge, NULL};
+
+            for (int threads = 1;; threads = threads * 2 < maxThreads ? threads * 2 : maxThreads)
+            {
+                TreeSummary summary;
+                BENCH_BEGIN("parallelReduce");
+                result.threads = threads;
+                for (long long r = 0; r < repetitions; r++)
+                {
+                    long long start = nowNanos();
+                    parallelTreeReduce(root, threads, &reducer, &summary);
+                    long long elapsed = nowNanos() - start - timerOverhead;
+                    total += elapsed;
+                    histogramRecord(histogram, elapsed / nodes);
+                }
+                finishResult(report, &result, histogram, total, repetitions * nodes);
+                if (summary.count != nodes)
+                {
+                    fprintf(stderr, "parallelReduce: visited %lld of %lld nodes\n", summary.count, nodes);
+                }
+                if (threads == maxThreads)
+                {
+                    break;
+                }
+            }
+            result.threads = 1;
+        }
+
+        if (csvContains(config->operations, "treeDelete"))
+        {
+            int deleted;
+            BENCH_BEGIN("treeDelete");
+            BENCH_LOOP(histogram, total, size, config->batch, root = deleteTreeNode(root, keys[i], &deleted));
+            finishResult(report, &result, histogram, total, size);
+        }
+
+        freeAllTreeNodes();
+    }
+
+    if (treeMode != TREE_MODE_BPLUS && csvContains(config->operations, "parallelInsert"))
+    {
+        // Builds the tree from empty on 1, 2, 4... threads up to --threads.
+        // Every row runs the partitioned insert, so the 1-thread row is the
+        // base of the speedup; partitioning alone already beats the plain
+        // loop through locality. That loop is timed the same way as its own
+        // insertTreeNode row, unless the insertTreeNode op reports one
+        int maxThreads = config->threads > 0 ? config->threads : onlineCores();
+        maxThreads = maxThreads < TREE_PARALLEL_MAX_THREADS ? maxThreads : TREE_PARALLEL_MAX_THREADS;
+        long long repetitions = size >= 1000000 ? 1 : 1000000 / size;
+
+        if (!csvContains(config->operations, "insertTreeNode"))
+        {
+            BENCH_BEGIN("insertTreeNode");
+            for (long long r = 0; r < repetitions; r++)
+            {
+                TreeNode *root = NULL;
+                long long start = nowNanos();
+                for (long long i = 0; i < size; i++)
+                {
+                    root = insertTreeNode(root, keys[i]);
+                }
+                long long elapsed = nowNanos() - start - timerOverhead;
+                total += elapsed;
+                histogramRecord(histogram, elapsed / size);
+                resetAllTreeNodes();
+            }
+            finishResult(report, &result, histogram, total, repetitions * size);
+            freeAllTreeNodes();
+        }
+
+        for (int threads = 1;; threads = threads * 2 < maxThreads ? threads * 2 : maxThreads)
+        {
+            BENCH_BEGIN("parallelInsert");
+            result.threads = threads;
+            for (long long r = 0; r < repetitions; r++)
+            {
+                long long start = nowNanos();
+                parallelInsertTree(NULL, keys, size, threads);
+                long long elapsed = nowNanos() - start - timerOverhead;
+                total += elapsed;
+                histogramRecord(histogram, elapsed / size);
+                freeAllTreeNodes();
+            }
+            finishResult(report, &result, histogram, total, repetitions * size);
+            if (threads == maxThreads)
+            {
+                break;
+            }
+        }
+        result.threads = 1;
+    }
+
+    if (csvContains(config->operations, "bulkLoad"))
+    {
+        // One sample is a whole load (copy the keys, sort, dedupe, build),
+        // reported per key so it compares directly with insertTreeNode
+        long long repetitions = size >= 1000000 ? 3 : 3000000 / size;
+        int *scratch = (int *)malloc(size * sizeof(int));
+        if (scratch == NULL)
+        {
+            fprintf(stderr, "Memory allocation failed!\n");
+            exit(EXIT_FAILURE);
+        }
+
+        BENCH_BEGIN("bulkLoad");
+        for (long long r = 0; r < repetitions; r++)
+        {
+            TreeNode *root = NULL;
+            BPlusTree bplus = {NULL, 0, 0};
+            long long start = nowNanos();
+            memcpy(scratch, keys, size * sizeof(int));
+            bulkLoadTree(&root, &bplus, scratch, size);
+            long long elapsed = nowNanos() - start - timerOverhead;
+            total += elapsed;
+            histogramRecord(histogram, elapsed / size);
+            resetAllTreeNodes();
+            freeBPlusTree(&bplus);
+        }
+        finishResult(report, &result, histogram, total, repetitions * size);
+        freeAllTreeNodes();
+        free(scratch);
+    }
+
+#undef BENCH_BEGIN
+
+    free(keys);
+    free(histogram);
+}
+
+// Concurrency Benchmark Functions-----------------------------------------------------
+
+#ifndef _WIN32
+typedef struct
+{
+    SpscQueue *spsc;
+    Queue *queue;
+    pthread_mutex_t *lock;
+    long long count;
+    long long checksum;
+    int bulk;
+} TransferArgs;
+
+void *spscProducer(void *arg)
+{
+    TransferArgs *args = (TransferArgs *)arg;
+    int spins = 0;
+
+    if (args->bulk)
+    {
+        int chunk[256];
+        for (long long sent = 0; sent < args->count;)
+        {
+            size_t want = args->count - sent < 256 ? (size_t)(args->count - sent) : 256;
+            for (size_t i = 0; i < want; i++)
+            {
+                chunk[i] = (int)(sent + i);
+            }
+            size_t done = 0;
+            while (done < want)
+            {
+                size_t pushed = spscEnqueueBulk(args->spsc, chunk + done, want - done);
+                done += pushed;
+                if (pushed == 0)
+                {
+                    backoffWait(&spins);
+                }
+            }
+            sent += want;
+        }
+        return NULL;
+    }
+
+    for (long long i = 0; i < args->count; i++)
+    {
+        while (!spscTryEnqueue(args->spsc, (int)i))
+        {
+            backoffWait(&spins);
+        }
+    }
+    spscFlush(args->spsc);
+    return NULL;
+}
+
+void *spscConsumer(void *arg)
+{
+    TransferArgs *args = (TransferArgs *)arg;
+    long long received = 0, checksum = 0;
+    int spins = 0;
+    int chunk[256];
+
+    while (received < args->count)
+    {
+        if (args->bulk)
+        {
+            size_t got = spscDequeueBulk(args->spsc, chunk, 256);
+            for (size_t i = 0; i < got; i++)
+            {
+                checksum += chunk[i];
+            }
+            received += got;
+            if (got == 0)
+            {
+                backoffWait(&spins);
+            }
+        }
+        else
+        {
+            int item;
+            if (spscTryDequeue(args->spsc, &item))
+            {
+                checksum += item;
+                received++;
+            }
+            else
+            {
+                backoffWait(&spins);
+            }
+        }
+    }
+    spscRelease(args->spsc);
+    args->checksum = checksum;
+    return NULL;
+}
+
+// Baseline: the ordinary Queue shared through a mutex
+void *mutexQueueProducer(void *arg)
+{
+    TransferArgs *args = (TransferArgs *)arg;
+    for (long long i = 0; i < args->count; i++)
+    {
+        pthread_mutex_lock(args->lock);
+        enqueue(args->queue, (int)i);
+        pthread_mutex_unlock(args->lock);
+    }
+    return NULL;
+}
+
+void *mutexQueueConsumer(void *arg)
+{
+    TransferArgs *args = (TransferArgs *)arg;
+    long long received = 0, checksum = 0;
+    int spins = 0;
+
+    while (received < args->count)
+    {
+        int item = 0, got = 0;
+        pthread_mutex_lock(args->lock);
+        if (!isQueueEmpty(args->queue))
+        {
+            item = dequeue(args->queue);
+            got = 1;
+        }
+        pthread_mutex_unlock(args->lock);
+
+        if (got)
+        {
+            checksum += item;
+            received++;
+        }
+        else
+        {
+            backoffWait(&spins);
+        }
+    }
+    args->checksum = checksum;
+    return NULL;
+}
+
+// Runs one producer and one consumer thread and reports the transfer rate
+void runTransfer(BenchReport *report, const char *name, void *(*producer)(void *),
+                 void *(*consumer)(void *), TransferArgs *args)
+{
+    pthread_t producerThread, consumerThread;
+    long long expected = args->count * (args->count - 1) / 2;
+
+    long long start = nowNanos();
+    pthread_create(&consumerThread, NULL, consumer, args);
+    pthread_create(&producerThread, NULL, producer, args);
+    pthread_join(producerThread, NULL);
+    pthread_join(consumerThread, NULL);
+    long long elapsed = nowNanos() - start;
+
+    if (args->checksum != expected)
+    {
+        fprintf(stderr, "%s: checksum mismatch, items were lost or duplicated!\n", name);
+    }
+    reportThroughput(report, name, "p1c1", args->count, 2, elapsed);
+}
+#endif
+
+void benchmarkSpsc(BenchConfig *config, BenchReport *report)
+{
+#ifdef _WIN32
+    (void)config;
+    (void)report;
+    fprintf(stderr, "The SPSC benchmark needs POSIX threads; skipped on Windows.\n");
+#else
+    TransferArgs args = {0};
+    args.count = config->spscCount;
+
+    args.spsc = createSpscQueue(65536, config->publishBatch);
+    runTransfer(report, "spscQueue", spscProducer, spscConsumer, &args);
+    freeSpscQueue(args.spsc);
+
+    args.bulk = 1;
+    args.spsc = createSpscQueue(65536, config->publishBatch);
+    runTransfer(report, "spscQueueBulk", spscProducer, spscConsumer, &args);
+    freeSpscQueue(args.spsc);
+
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    args.queue = createQueue(16);
+    args.lock = &lock;
+    runTransfer(report, "mutexQueue", mutexQueueProducer, mutexQueueConsumer, &args);
+    freeQueue(args.queue);
+#endif
+}
+
+#ifndef _WIN32
+#define SCALING_MPMC 0  // Bounded Vyukov ring
+#define SCALING_MS 1    // Unbounded Michael-Scott queue
+#define SCALING_MUTEX 2 // Growable Queue behind a mutex
+
+typedef struct
+{
+    int kind;
+    MpmcQueue *mpmc;
+    MsQueue *ms;
+    Queue *queue;
+    pthread_mutex_t lock;
+    long long perThread; // Items each producer sends and each consumer takes
+    atomic_llong checksum;
+} ScalingRun;
+
+typedef struct
+{
+    ScalingRun *run;
+    long long first; // First value this producer sends
+} ScalingWorker;
+
+void *scalingProducer(void *arg)
+{
+    ScalingWorker *worker = (ScalingWorker *)arg;
+    ScalingRun *run = worker->run;
+    HazardRecord *record = run->kind == SCALING_MS ? msQueueAttach(run->ms) : NULL;
+
+    for (long long i = worker->first; i < worker->first + run->perThread; i++)
+    {
+        if (run->kind == SCALING_MPMC)
+        {
+            mpmcEnqueue(run->mpmc, (int)i);
+        }
+        else if (run->kind == SCALING_MS)
+        {
+            msEnqueue(run->ms, record, (int)i);
+        }
+        else
+        {
+            pthread_mutex_lock(&run->lock);
+            enqueue(run->queue, (int)i);
+            pthread_mutex_unlock(&run->lock);
+        }
+    }
+
+    if (record != NULL)
+    {
+        msQueueDetach(record);
+    }
+    return NULL;
+}
+
+void *scalingConsumer(void *arg)
+{
+    ScalingWorker *worker = (ScalingWorker *)arg;
+    ScalingRun *run = worker->run;
+    HazardRecord *record = run->kind == SCALING_MS ? msQueueAttach(run->ms) : NULL;
+    long long checksum = 0;
+
+    for (long long received = 0; received < run->perThread; received++)
+    {
+        if (run->kind == SCALING_MPMC)
+        {
+            checksum += mpmcDequeue(run->mpmc);
+        }
+        else if (run->kind == SCALING_MS)
+        {
+            checksum += msDequeue(run->ms, record);
+        }
+        else
+        {
+            int spins = 0;
+            for (;;)
+            {
+                pthread_mutex_lock(&run->lock);
+                int got = !isQueueEmpty(run->queue);
+                int item = got ? dequeue(run->queue) : 0;
+                pthread_mutex_unlock(&run->lock);
+                if (got)
+                {
+                    checksum += item;
+                    break;
+                }
+                backoffWait(&spins);
+            }
+        }
+    }
+
+    if (record != NULL)
+    {
+        msQueueDetach(record);
+    }
+    atomic_fetch_add(&run->checksum, checksum);
+    return NULL;
+}
+
+// Runs `pairs` producers against `pairs` consumers on one shared queue
+void runScaling(BenchReport *report, const char *name, ScalingRun *run, long long count, int pairs)
+{
+    pthread_t threads[2 * HAZARD_MAX_THREADS];
+    ScalingWorker workers[2 * HAZARD_MAX_THREADS];
+    char label[32];
+
+    run->perThread = count / pairs;
+    long long total = run->perThread * pairs;
+    atomic_store(&run->checksum, 0);
+
+    long long start = nowNanos();
+    for (int i = 0; i < pairs; i++)
+    {
+        workers[i].run = workers[pairs + i].run = run;
+        workers[i].first = i * run->perThread;
+        pthread_create(&threads[pairs + i], NULL, scalingConsumer, &workers[pairs + i]);
+        pthread_create(&threads[i], NULL, scalingProducer, &workers[i]);
+    }
+    for (int i = 0; i < 2 * pairs; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    long long elapsed = nowNanos() - start;
+
+    if (atomic_load(&run->checksum) != total * (total - 1) / 2)
+    {
+        fprintf(stderr, "%s: checksum mismatch, items were lost or duplicated!\n", name);
+    }
+    snprintf(label, sizeof(label), "p%dc%d", pairs, pairs);
+    reportThroughput(report, name, label, total, 2 * pairs, elapsed);
+}
+#endif
+
+// Scaling run for the multi-producer queues: 1, 2, 4... producer/consumer
+// pairs, up to --threads workers in total (default: one per online core)
+void benchmarkMpmc(BenchConfig *config, BenchReport *report)
+{
+#ifdef _WIN32
+    (void)config;
+    (void)report;
+    fprintf(stderr, "The MPMC benchmark needs POSIX threads; skipped on Windows.\n");
+#else
+    int maxThreads = config->threads > 0 ? config->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int maxPairs = maxThreads / 2 > 1 ? maxThreads / 2 : 1;
+    if (maxPairs > HAZARD_MAX_THREADS / 2)
+    {
+        maxPairs = HAZARD_MAX_THREADS / 2;
+    }
+
+    for (int pairs = 1;; pairs = pairs * 2 < maxPairs ? pairs * 2 : maxPairs)
+    {
+        ScalingRun run = {0};
+        pthread_mutex_init(&run.lock, NULL);
+
+        run.kind = SCALING_MPMC;
+        run.mpmc = createMpmcQueue(65536);
+        runScaling(report, "mpmcQueue", &run, config->mpmcCount, pairs);
+        freeMpmcQueue(run.mpmc);
+
+        run.kind = SCALING_MS;
+        run.ms = createMsQueue();
+        runScaling(report, "msQueue", &run, config->mpmcCount, pairs);
+        freeMsQueue(run.ms);
+
+        run.kind = SCALING_MUTEX;
+        run.queue = createQueue(16);
+        runScaling(report, "mutexQueue", &run, config->mpmcCount, pairs);
+        freeQueue(run.queue);
+
+        pthread_mutex_destroy(&run.lock);
+        if (pairs == maxPairs)
+        {
+            break;
+        }
+    }
+#endif
+}
+
+#ifndef _WIN32
+#define CONTENTION_TREIBER 0     // Treiber stack, plain CAS retry
+#define CONTENTION_ELIMINATION 1 // Treiber stack with an elimination array
+#define CONTENTION_MUTEX 2       // Growable Stack behind a mutex
+
+typedef struct
+{
+    int kind;
+    TreiberStack *treiber;
+    Stack *stack;
+    pthread_mutex_t lock;
+    long long opsPerThread;
+    atomic_llong pushed; // Sum of every value pushed
+    atomic_llong popped; // Sum of every value popped
+} StackRun;
+
+// Each thread pushes a value and pops one back, the way a shared free list
+// or work pool is used
+void *stackWorker(void *arg)
+{
+    StackRun *run = (StackRun *)arg;
+    long long pushed = 0, popped = 0;
+
+    for (long long i = 0; i < run->opsPerThread; i++)
+    {
+        int item = (int)(i & 0xffff), got = 0, value = 0;
+        if (run->kind == CONTENTION_MUTEX)
+        {
+            pthread_mutex_lock(&run->lock);
+            push(run->stack, item);
+            pthread_mutex_unlock(&run->lock);
+            pthread_mutex_lock(&run->lock);
+            if (!isStackEmpty(run->stack))
+            {
+                value = pop(run->stack);
+                got = 1;
+            }
+            pthread_mutex_unlock(&run->lock);
+        }
+        else
+        {
+            if (!treiberTryPush(run->treiber, item))
+            {
+                continue;
+            }
+            got = treiberTryPop(run->treiber, &value);
+        }
+
+        pushed += item;
+        popped += got ? value : 0;
+    }
+
+    atomic_fetch_add(&run->pushed, pushed);
+    atomic_fetch_add(&run->popped, popped);
+    return NULL;
+}
+
+void runStackContention(BenchReport *report, const char *name, StackRun *run, long long count, int threadCount)
+{
+    pthread_t threads[HAZARD_MAX_THREADS];
+    char label[32];
+
+    run->opsPerThread = count / threadCount;
+    atomic_store(&run->pushed, 0);
+    atomic_store(&run->popped, 0);
+
+    long long start = nowNanos();
+    for (int i = 0; i < threadCount; i++)
+    {
+        pthread_create(&threads[i], NULL, stackWorker, run);
+    }
+    for (int i = 0; i < threadCount; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    long long elapsed = nowNanos() - start;
+
+    // Whatever was not popped by the workers must still be on the stack
+    long long leftover = 0;
+    int item;
+    if (run->kind == CONTENTION_MUTEX)
+    {
+        while (!isStackEmpty(run->stack))
+        {
+            leftover += pop(run->stack);
+        }
+    }
+    else
+    {
+        while (treiberTryPop(run->treiber, &item))
+        {
+            leftover += item;
+        }
+    }
+    if (atomic_load(&run->pushed) != atomic_load(&run->popped) + leftover)
+    {
+        fprintf(stderr, "%s: checksum mismatch, items were lost or duplicated!\n", name);
+    }
+
+    // Every worker does a push and a pop per iteration
+    snprintf(label, sizeof(label), "t%d", threadCount);
+    reportThroughput(report, name, label, 2 * run->opsPerThread * threadCount, threadCount, elapsed);
+}
+#endif
+
+// Contention run for the concurrent stacks with 1, 2, 4... threads, up to
+// --threads (default: one per online core)
+void benchmarkTreiber(BenchConfig *config, BenchReport *report)
+{
+#ifdef _WIN32
+    (void)config;
+    (void)report;
+    fprintf(stderr, "The Treiber stack benchmark needs POSIX threads; skipped on Windows.\n");
+#else
+    int maxThreads = config->threads > 0 ? config->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (maxThreads > HAZARD_MAX_THREADS)
+    {
+        maxThreads = HAZARD_MAX_THREADS;
+    }
+
+    for (int threadCount = 1;; threadCount = threadCount * 2 < maxThreads ? threadCount * 2 : maxThreads)
+    {
+        StackRun run = {0};
+        pthread_mutex_init(&run.lock, NULL);
+
+        run.kind = CONTENTION_TREIBER;
+        run.treiber = createTreiberStack(65536, 0);
+        runStackContention(report, "treiberStack", &run, config->treiberCount, threadCount);
+        freeTreiberStack(run.treiber);
+
+        run.kind = CONTENTION_ELIMINATION;
+        run.treiber = createTreiberStack(65536, threadCount > 1 ? threadCount / 2 : 1);
+        runStackContention(report, "treiberElimination", &run, config->treiberCount, threadCount);
+        freeTreiberStack(run.treiber);
+
+        run.kind = CONTENTION_MUTEX;
+        run.stack = createStack(16);
+        runStackContention(report, "mutexStack", &run, config->treiberCount, threadCount);
+        freeStack(run.stack);
+
+        pthread_mutex_destroy(&run.lock);
+        if (threadCount == maxThreads)
+        {
+            break;
+        }
+    }
+#endif
+}
+
+#ifndef _WIN32
+#define SKIP_BENCH_RANGE 65536 // Keys come from [0, range); the even half starts in the set
+
+typedef struct
+{
+    LfSkipList *lockFree; // NULL runs the mutex baseline on locked
+    SkipList *locked;
+    pthread_mutex_t lock;
+    long long opsPerThread;
+    atomic_llong added; // Successful inserts minus successful deletes
+} SkipRun;
+
+typedef struct
+{
+    SkipRun *run;
+    unsigned long long seed;
+} SkipWorker;
+
+// A read-mostly set workload: 80% searches, 10% inserts, 10% deletes
+void *skipWorker(void *arg)
+{
+    SkipWorker *worker = (SkipWorker *)arg;
+    SkipRun *run = worker->run;
+    long long added = 0;
+
+    for (long long i = 0; i < run->opsPerThread; i++)
+    {
+        unsigned long long random = nextRandom(&worker->seed);
+        int key = (int)(random % SKIP_BENCH_RANGE);
+        int action = (int)((random >> 32) % 10);
+        if (run->lockFree != NULL)
+        {
+            if (action == 0)
+            {
+                added += lfSkipInsert(run->lockFree, key);
+            }
+            else if (action == 1)
+            {
+                added -= lfSkipRemove(run->lockFree, key);
+            }
+            else
+            {
+                lfSkipContains(run->lockFree, key);
+            }
+        }
+        else
+        {
+            pthread_mutex_lock(&run->lock);
+            if (action == 0)
+            {
+                added += skipInsert(run->locked, key);
+            }
+            else if (action == 1)
+            {
+                added -= skipDelete(run->locked, key);
+            }
+            else
+            {
+                skipSearch(run->locked, key);
+            }
+            pthread_mutex_unlock(&run->lock);
+        }
+    }
+
+    atomic_fetch_add(&run->added, added);
+    return NULL;
+}
+
+void runSkipContention(BenchReport *report, const char *name, SkipRun *run, long long count, int threadCount)
+{
+    pthread_t threads[HAZARD_MAX_THREADS];
+    SkipWorker workers[HAZARD_MAX_THREADS];
+    char label[32];
+
+    for (int key = 0; key < SKIP_BENCH_RANGE; key += 2)
+    {
+        if (run->lockFree != NULL)
+        {
+            lfSkipInsert(run->lockFree, key);
+        }
+        else
+        {
+            skipInsert(run->locked, key);
+        }
+    }
+    run->opsPerThread = count / threadCount;
+    atomic_store(&run->added, 0);
+
+    long long start = nowNanos();
+    for (int i = 0; i < threadCount; i++)
+    {
+        workers[i].run = run;
+        workers[i].seed = 0x9E3779B97F4A7C15ull * (i + 1);
+        pthread_create(&threads[i], NULL, skipWorker, &workers[i]);
+    }
+    for (int i = 0; i < threadCount; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    long long elapsed = nowNanos() - start;
+
+    long long size = run->lockFree != NULL ? lfSkipCount(run->lockFree) : run->locked->length;
+    if (size != SKIP_BENCH_RANGE / 2 + atomic_load(&run->added))
+    {
+        fprintf(stderr, "%s: size mismatch, keys were lost or duplicated!\n", name);
+    }
+
+    snprintf(label, sizeof(label), "t%d", threadCount);
+    reportThroughput(report, name, label, run->opsPerThread * threadCount, threadCount, elapsed);
+}
+#endif
+
+// Contention run for the lock-free skip list against a skip list behind a
+// mutex, with 1, 2, 4... threads up to --threads
+void benchmarkSkipList(BenchConfig *config, BenchReport *report)
+{
+#ifdef _WIN32
+    (void)config;
+    (void)report;
+    fprintf(stderr, "The skip list benchmark needs POSIX threads; skipped on Windows.\n");
+#else
+    int maxThreads = config->threads > 0 ? config->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (maxThreads > HAZARD_MAX_THREADS)
+    {
+        maxThreads = HAZARD_MAX_THREADS;
+    }
+
+    for (int threadCount = 1;; threadCount = threadCount * 2 < maxThreads ? threadCount * 2 : maxThreads)
+    {
+        SkipRun run = {0};
+        pthread_mutex_init(&run.lock, NULL);
+
+        run.lockFree = createLfSkipList();
+        runSkipContention(report, "lockFreeSkipList", &run, config->skipCount, threadCount);
+        freeLfSkipList(run.lockFree);
+
+        run.lockFree = NULL;
+        run.locked = createSkipList();
+        runSkipContention(report, "mutexSkipList", &run, config->skipCount, threadCount);
+        freeSkipList(run.locked);
+
+        pthread_mutex_destroy(&run.lock);
+        if (threadCount == maxThreads)
+        {
+            break;
+        }
+    }
+#endif
+}
+
+int runBenchSuite(BenchConfig *config)
+{
+    static const char *distributionNames[3] = {"seq", "random", "zipf"};
+    static const char *perfColumns[PERF_EVENTS] = {"cyc/op", "ins/op", "L1d/op", "LLC/op", "brmiss/op", "dTLB/op"};
+    BenchReport report = {stdout, config->format, 0, NULL};
+    PerfCounters counters;
+
+    calibrateTimer();
+    if (config->perf)
+    {
+        perfOpen(&counters);
+        report.perf = &counters;
+    }
+
+    if (config->format == BENCH_FORMAT_JSON)
+    {
+        fprintf(report.out, "[\n");
+    }
+    else if (config->format == BENCH_FORMAT_CSV)
+    {
+        fprintf(report.out, "op,dist,size,threads,ns_per_op,ops_per_sec,p50_ns,p99_ns,p999_ns,peak_rss_kb");
+    }
+    else
+    {
+        fprintf(report.out, "%-18s %-10s %12s %7s %10s %14s %8s %8s %8s %10s",
+                "operation", "dist", "size", "threads", "ns/op", "ops/s", "p50", "p99", "p999", "rss_kb");
+    }
+    for (int i = 0; report.perf != NULL && config->format != BENCH_FORMAT_JSON && i < PERF_EVENTS; i++)
+    {
+        if (config->format == BENCH_FORMAT_CSV)
+        {
+            fprintf(report.out, ",%s_per_op", perfEventNames[i]);
+        }
+        else
+        {
+            fprintf(report.out, " %9s", perfColumns[i]);
+        }
+    }
+    if (config->format != BENCH_FORMAT_JSON)
+    {
+        fprintf(report.out, "\n");
+    }
+
+    for (int s = 0; s < config->sizeCount; s++)
+    {
+        for (int d = 0; d < 3; d++)
+        {
+            if (csvContains(config->distributions, distributionNames[d]))
+            {
+                benchmarkOneSize(config, &report, config->sizes[s], d, distributionNames[d]);
+            }
+        }
+    }
+
+    if (config->spscCount > 0)
+    {
+        benchmarkSpsc(config, &report);
+    }
+    if (config->mpmcCount > 0)
+    {
+        benchmarkMpmc(config, &report);
+    }
+    if (config->treiberCount > 0)
+    {
+        benchmarkTreiber(config, &report);
+    }
+    if (config->skipCount > 0)
+    {
+        benchmarkSkipList(config, &report);
+    }
+
+    if (config->format == BENCH_FORMAT_JSON)
+    {
+        fprintf(report.out, "\n]\n");
+    }
+    if (report.perf != NULL)
+    {
+        perfClose(report.perf);
+    }
+    return 0;
+}
+
+void printKey(int key, void *context)
+{
+    (void)context;
+    printf("%d ", key);
+}
+
+// "bst", "avl" or "bplus" to a TREE_MODE_* value, -1 if unknown
+int parseTreeMode(const char *name)
+{
+    if (strcmp(name, "bst") == 0)
+    {
+        return TREE_MODE_BST;
+    }
+    if (strcmp(name, "avl") == 0)
+    {
+        return TREE_MODE_AVL;
+    }
+    if (strcmp(name, "bplus") == 0)
+    {
+        return TREE_MODE_BPLUS;
+    }
+    return -1;
+}
+
+// --bulk: loads the file into a fresh tree of the --tree engine and prints
+// the key counts, height and load time to stderr
+int runBulkLoad(const char *path)
+{
+    TreeNode *root = NULL;
+    BPlusTree bplus = {NULL, 0, 0};
+    long long read, start = nowNanos();
+    long long distinct = bulkLoadFile(path, &root, &bplus, &read);
+    long long elapsed = nowNanos() - start;
+
+    if (distinct < 0)
+    {
+        fprintf(stderr, "Cannot open key file '%s'\n", path);
+        return 1;
+    }
+    fprintf(stderr, "Bulk loaded %lld keys (%lld distinct), height %d, in %.3f ms\n", read, distinct,
+            treeMode == TREE_MODE_BPLUS ? bplus.height : treeHeight(root), elapsed / 1e6);
+
+    recordTreeShape(root, &bplus);
+    freeAllTreeNodes();
+    freeBPlusTree(&bplus);
+    return 0;
+}
+
+int runScript(const char *path, int capacity)
+{
+    FILE *input = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (input == NULL)
+    {
+        fprintf(stderr, "Cannot open script '%s'\n", path);
+        return 1;
+    }
+
+    LinkedList list = {NULL, NULL, 0};
+    UnrolledList unrolled = {NULL, NULL, 0, 0};
+    Stack *stack = createStack(capacity);
+    Queue *queue = createQueue(capacity);
+    TreeNode *root = NULL;
+    BPlusTree bplus = {NULL, 0, 0};
+    SkipList *skip = createSkipList();
+
+    char line[256];
+    char structure[16], operation[16];
+    int value, lineNumber = 0, status = 0;
+    long long operations = 0, rejected = 0;
+    long long start = nowNanos();
+
+    while (fgets(line, sizeof(line), input) != NULL)
+    {
+        lineNumber++;
+
+        char mode[16], file[200];
+        int high;
+        if (sscanf(line, "save %15s %199s", structure, file) == 2 ||
+            sscanf(line, "load %15s %199s", structure, file) == 2)
+        {
+            int saving = line[0] == 's', ok = 0;
+            if (strcmp(structure, "list") == 0)
+            {
+                ok = saving ? saveListSnapshot(&list, &unrolled, file) : loadListSnapshot(&list, &unrolled, file);
+            }
+            else if (strcmp(structure, "stack") == 0)
+            {
+                Stack *loaded = saving ? NULL : loadStackSnapshot(file);
+                ok = saving ? saveStackSnapshot(stack, file) : loaded != NULL;
+                if (loaded != NULL)
+                {
+                    freeStack(stack);
+                    stack = loaded;
+                }
+            }
+            else if (strcmp(structure, "queue") == 0)
+            {
+                Queue *loaded = saving ? NULL : loadQueueSnapshot(file);
+                ok = saving ? saveQueueSnapshot(queue, file) : loaded != NULL;
+                if (loaded != NULL)
+                {
+                    freeQueue(queue);
+                    queue = loaded;
+                }
+            }
+            else if (strcmp(structure, "tree") == 0)
+            {
+                ok = saving ? saveTreeSnapshot(root, &bplus, file) : loadTreeSnapshot(file, &root, &bplus);
+            }
+            if (!ok)
+            {
+                fprintf(stderr, "Line %d: cannot %s %s snapshot '%s'\n", lineNumber,
+                        saving ? "save" : "load", structure, file);
+                status = 1;
+                break;
+            }
+            continue;
+        }
+        if (sscanf(line, "tree bulk %199s", file) == 1)
+        {
+            long long read;
+            if (bulkLoadFile(file, &root, &bplus, &read) < 0)
+            {
+                fprintf(stderr, "Line %d: cannot open key file '%s'\n", lineNumber, file);
+                status = 1;
+                break;
+            }
+            continue;
+        }
+        if (sscanf(line, "tree ingest %199s", file) == 1)
+        {
+            // Plain inserts, but on every core; the tree keeps its shape
+            FILE *keyFile = strcmp(file, "-") == 0 ? stdin : fopen(file, "r");
+            if (keyFile == NULL)
+            {
+                fprintf(stderr, "Line %d: cannot open key file '%s'\n", lineNumber, file);
+                status = 1;
+                break;
+            }
+            long long count;
+            int *keys = readKeys(keyFile, &count);
+            if (keyFile != stdin)
+            {
+                fclose(keyFile);
+            }
+            if (treeMode == TREE_MODE_BPLUS)
+            {
+                for (long long i = 0; i < count; i++)
+                {
+                    bplusInsert(&bplus, keys[i]);
+                }
+            }
+            else
+            {
+                root = parallelInsertTree(root, keys, count, onlineCores());
+            }
+            free(keys);
+            continue;
+        }
+        if (sscanf(line, "list mode %15s", mode) == 1)
+        {
+            if (strcmp(mode, "nodes") != 0 && strcmp(mode, "unrolled") != 0)
+            {
+                fprintf(stderr, "Line %d: unknown list mode '%s'\n", lineNumber, mode);
+                status = 1;
+                break;
+            }
+            setListMode(&list, &unrolled, strcmp(mode, "unrolled") == 0 ? LIST_MODE_UNROLLED : LIST_MODE_NODES);
+            continue;
+        }
+        if (sscanf(line, "tree mode %15s", mode) == 1)
+        {
+            if (parseTreeMode(mode) < 0)
+            {
+                fprintf(stderr, "Line %d: unknown tree mode '%s'\n", lineNumber, mode);
+                status = 1;
+                break;
+            }
+            root = setTreeMode(root, &bplus, parseTreeMode(mode));
+            continue;
+        }
+        if (sscanf(line, "tree range %d %d", &value, &high) == 2 && treeMode == TREE_MODE_BPLUS)
+        {
+            bplusRangeScan(&bplus, value, high, printKey, NULL);
+            printf("\n");
+            continue;
+        }
+        if (sscanf(line, "skip range %d %d", &value, &high) == 2)
+        {
+            skipRangeScan(skip, value, high, printKey, NULL);
+            printf("\n");
+            continue;
+        }
+        // Whole tokens, so "statsfoo" or "tree statsfoo" still falls through
+        // to the parse error
+        char word[16], second[16];
+        int words = sscanf(line, "%15s %15s", word, second);
+        if (words >= 1 && strcmp(word, "stats") == 0)
+        {
+            recordTreeShape(root, &bplus);
+            writeStatsJson(stdout);
+            continue;
+        }
+        if (words == 2 && strcmp(word, "tree") == 0 && strcmp(second, "stats") == 0 && treeMode != TREE_MODE_BPLUS)
+        {
+            TreeSummary summary;
+            TreeReducer reducer = {sizeof(TreeSummary), summaryInit, summaryVisit, summaryMerge, NULL};
+            parallelTreeReduce(root, onlineCores(), &reducer, &summary);
+            if (summary.count == 0)
+            {
+                printf("count 0\n");
+            }
+            else
+            {
+                printf("count %lld sum %lld min %d max %d\n", summary.count, summary.sum, summary.min, summary.max);
+            }
+            continue;
+        }
+        if (sscanf(line, "tree filter %d %d", &value, &high) == 2 && treeMode != TREE_MODE_BPLUS)
+        {
+            // Workers collect in no particular order; sorted for stable output
+            int bounds[2] = {value, high};
+            TreeFilter filter = {keyInRange, bounds};
+            TreeReducer reducer = {sizeof(KeyArray), filterInit, filterVisit, filterMerge, &filter};
+            KeyArray kept;
+            parallelTreeReduce(root, onlineCores(), &reducer, &kept);
+            radixSortKeys(kept.keys, kept.count);
+            for (long long i = 0; i < kept.count; i++)
+            {
+                printf("%d ", kept.keys[i]);
+            }
+            printf("\n");
+            free(kept.keys);
+            continue;
+        }
+
+        char *comment = strchr(line, '#');
+        if (comment != NULL)
+        {
+            *comment = '\0';
+        }
+
+        int fields = sscanf(line, "%15s %15s %d", structure, operation, &value);
+        if (fields <= 0)
+        {
+            continue; // Blank or comment-only line
+        }
+
+        if (strcmp(structure, "list") == 0 && fields == 3 && strcmp(operation, "insert") == 0)
+        {
+            if (listMode == LIST_MODE_UNROLLED)
+            {
+                unrolledInsert(&unrolled, value);
+            }
+            else
+            {
+                insertNode(&list, value);
+            }
+        }
+        else if (strcmp(structure, "list") == 0 && fields == 3 && strcmp(operation, "delete") == 0)
+        {
+            if (listMode == LIST_MODE_UNROLLED)
+            {
+                unrolledDelete(&unrolled, value);
+            }
+            else
+            {
+                deleteNode(&list, value);
+            }
+        }
+        else if (strcmp(structure, "stack") == 0 && fields == 3 && strcmp(operation, "push") == 0)
+        {
+            push(stack, value);
+        }
+        else if (strcmp(structure, "stack") == 0 && fields == 2 && strcmp(operation, "pop") == 0)
+        {
+            if (isStackEmpty(stack))
+            {
+                rejected++;
+            }
+            pop(stack);
+        }
+        else if (strcmp(structure, "queue") == 0 && fields == 3 && strcmp(operation, "enqueue") == 0)
+        {
+            enqueue(queue, value);
+        }
+        else if (strcmp(structure, "queue") == 0 && fields == 2 && strcmp(operation, "dequeue") == 0)
+        {
+            if (isQueueEmpty(queue))
+            {
+                rejected++;
+            }
+            dequeue(queue);
+        }
+        else if (strcmp(structure, "tree") == 0 && fields == 3 && strcmp(operation, "insert") == 0)
+        {
+            if (treeMode == TREE_MODE_BPLUS)
+            {
+                bplusInsert(&bplus, value);
+            }
+            else
+            {
+                root = insertTreeNode(root, value);
+            }
+        }
+        else if (strcmp(structure, "tree") == 0 && fields == 3 && strcmp(operation, "search") == 0)
+        {
+            int found = treeMode == TREE_MODE_BPLUS ? bplusSearch(&bplus, value)
+                                                    : searchTreeNode(root, value) != NULL;
+            printf("%d %s\n", value, found ? "found" : "missing");
+        }
+        else if (strcmp(structure, "tree") == 0 && fields == 3 && strcmp(operation, "delete") == 0)
+        {
+            int deleted;
+            if (treeMode == TREE_MODE_BPLUS)
+            {
+                deleted = bplusDelete(&bplus, value);
+            }
+            else
+            {
+                root = deleteTreeNode(root, value, &deleted);
+            }
+        }
+        else if (strcmp(structure, "skip") == 0 && fields == 3 && strcmp(operation, "insert") == 0)
+        {
+            skipInsert(skip, value);
+        }
+        else if (strcmp(structure, "skip") == 0 && fields == 3 && strcmp(operation, "delete") == 0)
+        {
+            skipDelete(skip, value);
+        }
+        else if (strcmp(structure, "skip") == 0 && fields == 3 && strcmp(operation, "search") == 0)
+        {
+            printf("%d %s\n", value, skipSearch(skip, value) ? "found" : "missing");
+        }
+        else if (strcmp(structure, "print") == 0 && fields == 2)
+        {
+            if (strcmp(operation, "list") == 0)
+            {
+                for (Node *current = list.head; current != NULL; current = current->next)
+                {
+                    printf("%d ", current->data);
+                }
+                for (ListChunk *chunk = unrolled.head; chunk != NULL; chunk = chunk->next)
+                {
+                    for (int i = 0; i < chunk->count; i++)
+                    {
+                        printf("%d ", chunk->values[i]);
+                    }
+                }
+            }
+            else if (strcmp(operation, "stack") == 0)
+            {
+                for (int i = 0; i <= stack->top; i++)
+                {
+                    printf("%d ", stack->array[i]);
+                }
+            }
+            else if (strcmp(operation, "queue") == 0)
+            {
+                for (int i = queue->front; !isQueueEmpty(queue); i = (i + 1) % queue->capacity)
+                {
+                    printf("%d ", queue->array[i]);
+                    if (i == queue->rear)
+                    {
+                        break;
+                    }
+                }
+            }
+            else if (strcmp(operation, "tree") == 0 && treeMode == TREE_MODE_BPLUS)
+            {
+                bplusRangeScan(&bplus, INT_MIN, INT_MAX, printKey, NULL);
+            }
+            else if (strcmp(operation, "tree") == 0)
+            {
+                inorderTraversal(root);
+            }
+            else if (strcmp(operation, "skip") == 0)
+            {
+                skipRangeScan(skip, INT_MIN, INT_MAX, printKey, NULL);
+            }
+            else
+            {
+                fprintf(stderr, "Line %d: unknown structure '%s'\n", lineNumber, operation);
+                status = 1;
+                break;
+            }
+            printf("\n");
+            continue;
+        }
+        else
+        {
+            fprintf(stderr, "Line %d: cannot parse command: %s", lineNumber, line);
+            status = 1;
+            break;
+        }
+        operations++;
+    }
+
+    long long elapsed = nowNanos() - start;
+    fprintf(stderr, "%lld operations (%lld rejected as empty) in %.3f s\n",
+            operations, rejected, elapsed / 1e9);
+
+    if (input != stdin)
+    {
+        fclose(input);
+    }
+    recordTreeShape(root, &bplus); // For --stats
+    freeAllListNodes();
+    freeAllListChunks();
+    freeStack(stack);
+    freeQueue(queue);
+    freeAllTreeNodes();
+    freeBPlusTree(&bplus);
+    freeSkipList(skip);
+
+    return status;
+}
+
+// Parses "1000,1e5,1e8" into config->sizes
+int parseSizes(BenchConfig *config, const char *list)
+{
+    const char *p = list;
+    config->sizeCount = 0;
+    while (*p != '\0')
+    {
+        char *end;
+        if (config->sizeCount == BENCH_MAX_SIZES)
+        {
+            return 0; // More sizes than the config holds
+        }
+        double size = strtod(p, &end);
+        if (end == p || size < 1)
+        {
+            return 0;
+        }
+        config->sizes[config->sizeCount++] = (long long)size;
+        p = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0')
+        {
+            return 0;
+        }
+    }
+    return config->sizeCount > 0;
+}
+
+int runBatchMode(int argc, char *argv[])
+{
+    const char *scriptPath = NULL;
+    const char *bulkPath = NULL;
+    const char *statsPath = NULL;
+    const char *tracePath = NULL;
+    int capacity = 16;
+    BenchConfig bench = {{0}, 0, "random", NULL, BENCH_FORMAT_TEXT, 16, 1, 0, 64, 0, 0, 0, 0, 0};
+
+    for (int i = 1; i < argc; i++)
+    {
+        int hasValue = i + 1 < argc;
+
+        if ((strcmp(argv[i], "--bench") == 0 || strcmp(argv[i], "--sizes") == 0) && hasValue)
+        {
+            if (!parseSizes(&bench, argv[++i]))
+            {
+                fprintf(stderr, "Invalid size list '%s'\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--dist") == 0 && hasValue)
+        {
+            bench.distributions = argv[++i];
+        }
+        else if (strcmp(argv[i], "--ops") == 0 && hasValue)
+        {
+            bench.operations = argv[++i];
+        }
+        else if (strcmp(argv[i], "--format") == 0 && hasValue)
+        {
+            i++;
+            if (strcmp(argv[i], "json") == 0)
+            {
+                bench.format = BENCH_FORMAT_JSON;
+            }
+            else if (strcmp(argv[i], "csv") == 0)
+            {
+                bench.format = BENCH_FORMAT_CSV;
+            }
+            else if (strcmp(argv[i], "text") == 0)
+            {
+                bench.format = BENCH_FORMAT_TEXT;
+            }
+            else
+            {
+                fprintf(stderr, "Unknown format '%s'\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--spsc") == 0 && hasValue)
+        {
+            bench.spscCount = (long long)strtod(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "--mpmc") == 0 && hasValue)
+        {
+            bench.mpmcCount = (long long)strtod(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "--treiber") == 0 && hasValue)
+        {
+            bench.treiberCount = (long long)strtod(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "--skiplist") == 0 && hasValue)
+        {
+            bench.skipCount = (long long)strtod(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "--perf") == 0)
+        {
+            bench.perf = 1;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+        {
+            bench.threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--publish-batch") == 0 && hasValue)
+        {
+            bench.publishBatch = (size_t)atoll(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--batch") == 0 && hasValue)
+        {
+            bench.batch = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--script") == 0 && hasValue)
+        {
+            scriptPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--bulk") == 0 && hasValue)
+        {
+            bulkPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && hasValue)
+        {
+            tracePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--stats") == 0 && hasValue)
+        {
+            statsPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--capacity") == 0 && hasValue)
+        {
+            capacity = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--tree") == 0 && hasValue)
+        {
+            treeMode = parseTreeMode(argv[++i]);
+            if (treeMode < 0)
+            {
+                fprintf(stderr, "Unknown tree mode '%s'\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            bench.seed = strtoull(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--help") == 0)
+        {
+            printUsage(argv[0]);
+            return 0;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown or incomplete option '%s'\n", argv[i]);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    int benchRequested = bench.sizeCount > 0 || bench.spscCount > 0 || bench.mpmcCount > 0 ||
+                         bench.treiberCount > 0 || bench.skipCount > 0;
+    if ((!benchRequested && scriptPath == NULL && bulkPath == NULL) || capacity <= 0 || bench.batch <= 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    headlessMode = 1;
+    if (tracePath != NULL)
+    {
+        startTracing();
+    }
+
+    int status = 0;
+    if (scriptPath != NULL)
+    {
+        status = runScript(scriptPath, capacity);
+    }
+    if (status == 0 && bulkPath != NULL)
+    {
+        status = runBulkLoad(bulkPath);
+    }
+    if (status == 0 && benchRequested)
+    {
+        status = runBenchSuite(&bench);
+    }
+    if (status == 0 && statsPath != NULL)
+    {
+        status = dumpStats(statsPath);
+    }
+    if (tracePath != NULL && traceFlush(tracePath) != 0)
+    {
+        status = 1;
+    }
+    return status;
 }